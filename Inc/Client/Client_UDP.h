@@ -11,14 +11,28 @@
 
 #include <stdint.h>
 
+#include "Shared_Configuration.h" // for CompletionMsg_t
+
+/* Completion journal counters - see ClientUDP_GetJournalStats() */
+typedef struct {
+    uint32_t appended;    // Completions accepted by the journal
+    uint32_t overflows;   // Appends that went to the overflow tier because the journal ring was full
+    uint32_t sent;        // Completions sent to the server
+    uint32_t batches;     // Datagrams sent
+    uint32_t maxBatch;    // Largest batch sent
+    uint32_t highWater;   // Max journal occupancy seen
+    uint32_t overflowHighWater; // Max overflow tier occupancy seen
+} CompletionJournalStats_t;
+
 /**
  * @brief Initializes the UDP CLient by creating and binding a socket to the predefined CLient port.
  *        It is used by the CLient tasks to communicate with the server over UDP on the same PORT.
  * 
  * @attention This function should be called once before using the CLient socket.
+ * @param port - UDP port to listen on (UDP_CLIENT_PORT for the default instance)
  * @return int Returns 0 on success, or a negative error code (9X) on failure.
  */
-int ClientUDP_Init(void);
+int ClientUDP_Init(uint16_t port);
 
 /**
  * @brief Retrieves the UDP CLient socket file descriptor.
@@ -39,8 +53,35 @@ int ClientUDP_GetSocket(void);
 void vClientUDPRxTask(void *pvParameters);
 
 /**
- * @brief This task handles transmitting EmergencyEvent_t messages via UDP from the client to the server.
- *        It receives messages from a queue and sends them over the network.
+ * @brief Appends a completion message to the client completion journal - the bounded ring while it has a free slot,
+ *        else a heap-allocated overflow tier that vClientUDPTxTask sends before the ring.
+ *        Never blocks and never loses a completion: vClientUDPTxTask is notified and drains the journal in batches.
+ * 
+ * @attention Safe to call from any client task. A heap exhausted by the overflow tier is fatal (configASSERT).
+ * @param msg - Completion message to copy into the journal
+ */
+void ClientUDP_PostCompletion(const CompletionMsg_t *msg);
+
+/**
+ * @brief Builds a completion message (end timestamp = now) and appends it to the completion journal
+ *        (see ClientUDP_PostCompletion - never blocks, never loses it).
+ * 
+ * @attention Safe to call from any client task - vehicles, dispatchers, managers, the UDP RX fast path, the service clock.
+ * @param eventID - Completed event
+ * @param handledBy - Name of the task / vehicle that handled (or dropped) the event
+ * @param status - STATUS_xxx
+ */
+void ClientUDP_JournalCompletion(uint32_t eventID, const char *handledBy, uint8_t status);
+
+/**
+ * @brief Copies the completion journal counters.
+ * @param stats - Output counters
+ */
+void ClientUDP_GetJournalStats(CompletionJournalStats_t *stats);
+
+/**
+ * @brief This task handles transmitting CompletionMsg_t messages via UDP from the client to the server.
+ *        It drains the completion journal and coalesces up to COMPLETION_BATCH_MAX completions per datagram.
  * 
  * @attention This task should be created after ClientUDP_Init() is called.
  * @param pvParameters - Not used
@@ -50,10 +91,10 @@ void vClientUDPTxTask(void *pvParameters);
 /**
  * @brief This task implements an echo mechanism: it receives EmergencyEvent_t messages from a queue,
  *        generates corresponding CompletionMsg_t messages, and sends them to the TX queue.
- *        This is a simple echo task for demonstration purposes.
+ *        Used as the whole client in transport benchmark mode (TRANSPORT_BENCH=1).
  * 
  * @attention It should be created after ClientUDP_Init() is called.
- * @param pvParameters - Not used
+ * @param pvParameters - Dispatcher shard index (cast to pointer) - the echo task drains the RX lanes of that shard
  */
 void vClientEchoTask(void *pvParameters);
 
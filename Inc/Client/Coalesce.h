@@ -0,0 +1,45 @@
+/**
+ * @file Coalesce.h
+ * @brief Incident de-duplication: reports of the same incident - same type and catalog item (event_detail) at the same
+ *        location within COALESCE_WINDOW_MS - are merged into the live incident by the dispatcher. Only the first
+ *        report enters the department backlog, the others are counted as extra reporters of it and completed right
+ *        away with STATUS_COALESCED, so duplicates never take a queue slot or a vehicle.
+ *        The index is a small open-addressing hash table keyed by (type, location, detail). Entries are stamped with
+ *        the time bucket (COALESCE_BUCKET_MS) of the first report and expire as whole buckets age out of the window,
+ *        or as soon as the incident is closed (served, cancelled or failed).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#ifndef COALESCE_H
+#define COALESCE_H
+
+#include "Shared_Configuration.h"
+
+/* --- Coalescing knobs --- */
+#ifndef COALESCE_ENABLE
+#define COALESCE_ENABLE            1     /* 0 = every report is dispatched on its own */
+#endif
+#define COALESCE_WINDOW_MS         10000 /* reports this close to the first one merge into it */
+#define COALESCE_BUCKET_MS         1000  /* time bucket granularity of the window */
+#define COALESCE_SLOTS             128   /* index size (power of 2) - live incidents tracked at once */
+#define COALESCE_PROBE_MAX         8     /* open addressing - slots probed per lookup */
+
+/**
+ * @brief Looks up the live incident of a report, or opens one for it.
+ * @attention Called by the dispatcher for every routed event, before it enters the department backlog.
+ * @param event - Reported event
+ * @param reporters - Output: reporters of the live incident so far, this one included (may be NULL)
+ * @return uint32_t ID of the live incident the report was merged into, 0 if it opened a new incident (dispatch it).
+ */
+uint32_t Coalesce_Admit(const EmergencyEvent_t *event, uint16_t *reporters);
+
+/**
+ * @brief Closes the incident of an event - later reports of it open a new incident.
+ * @attention Called whenever an event leaves the client for good (served, cancelled, failed). No-op for events that
+ *            did not open an incident (duplicates, or incidents that already aged out of the window).
+ * @param event - Event that opened the incident
+ */
+void Coalesce_Close(const EmergencyEvent_t *event);
+
+#endif // COALESCE_H
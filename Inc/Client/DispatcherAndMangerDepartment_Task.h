@@ -13,47 +13,110 @@
 #include "semphr.h"
 #include "Shared_Configuration.h"   // EventType_t, queues/sems handles, etc.
 #include "event_groups.h"          // Event groups
+#include "Client/MutualAid.h"       // MUTUAL_AID_xxx knobs
 
 /* --- Simple policy knobs --- */
-#define MANAGER_POLL_MS              50
-#define OVERLOAD_THRESHOLD           12   /* when queue len >= this -> overload mode */
-#define OVERLOAD_TARGET              8    /* after cancelling, try to get down to this */
+#define MANAGER_POLL_MS              50   /* overload - pause between cancel batches while the backlog stays above threshold */
+#define OVERLOAD_THRESHOLD           12   /* when queue len >= this -> overload mode (until the department has load estimates) */
+#define OVERLOAD_TARGET              8    /* after cancelling, try to get down to this (same ratio is kept by adaptive thresholds) */
 #define MAX_CANCEL_PER_CYCLE         2    /* avoid spending too long in one loop */
 #define BREAK_IDLE_MS                3000 /* if idle long enough -> allow breaks */
 #define BREAK_MAX_FRACTION_NUM       1    /* allow up to 1/2 vehicles on break */
 #define BREAK_MAX_FRACTION_DEN       2
 
-/* If you want to notify server on cancel, use status=1 for "not success".
-   (Your code/comments are inconsistent on 0/1 meaning; server prints status=0 currently.)
-*/
-#define STATUS_CANCELLED             1
+/* --- Predictive overload control (per department, from the EWMA load estimates - see DeptLoad_t) ---
+   Drain rate = active vehicles / service time, so by Little's law a backlog of L waits about L * service / active.
+   Overload (shedding) starts at the backlog whose predicted wait exceeds LOAD_SHED_WAIT_MS, so the threshold
+   follows each department's fleet size and service time. */
+#define LOAD_SHED_WAIT_MS            DEADLINE_LOW_MS /* shed once the predicted wait passes the least urgent deadline */
+#define LOAD_SHED_MIN                4    /* adaptive overload threshold clamp */
+#define LOAD_SHED_MAX                (DEPT_Q_LEN + DEPT_SPILL_CAP / 2)
+#define LOAD_BREAK_UTIL_PCT          50   /* a vehicle may go on break only if utilization without it stays below this */
+#define LOAD_RECALL_UTIL_PCT         80   /* recall vehicles from break once utilization of the active ones reaches this */
+
+/* --- Fleet autoscaler (AUTOSCALE_ENABLE, fleet bounds FLEET_MIN_PCT / FLEET_MAX_PCT - see Shared_Configuration.h) --- */
+#define AUTOSCALE_UP_WAIT_MS         20000 /* add a vehicle while the predicted wait stays above this ... */
+#define AUTOSCALE_UP_HOLD_MS         5000  /* ... for this long (again for every further vehicle) */
+#define AUTOSCALE_DOWN_IDLE_MS       20000 /* retire a vehicle once the backlog stayed empty this long (again for every further one) */
+#define AUTOSCALE_DOWN_UTIL_PCT      LOAD_BREAK_UTIL_PCT /* ... and utilization without it stays below this */
+
+/* --- Event TTL sweep (EVENT_TTL_ENABLE, TTL per priority TTL_xxx_MS - see Shared_Configuration.h) --- */
+#define EVENT_TTL_SWEEP_MS           5000  /* the manager scans the backlog for expired events this often - not on every wake */
+#define MAX_EXPIRE_PER_CYCLE         16    /* each drop scans the backlog - the rest go on the next sweep */
+
+/* Fixed backlog level that wakes the manager on every enqueue (the adaptive threshold d->load.shedAt wakes it too) */
+#if MUTUAL_AID_ENABLE
+#define MANAGER_WAKE_BACKLOG         MUTUAL_AID_BACKLOG
+#else
+#define MANAGER_WAKE_BACKLOG         LOAD_SHED_MIN
+#endif
+
+/* Supervisor mode (make MANAGER_SUPERVISOR=1) - one Task_Supervisor runs the policies of every department
+   instead of one Task_Manager_Departments_X per department */
+#ifndef MANAGER_SUPERVISOR
+#define MANAGER_SUPERVISOR           0
+#endif
+
+#define DISPATCHER_REPORT_MS         10000 /* period of the per-dispatcher throughput report */
+
+/* Throughput counters of one dispatcher shard - written by its dispatcher task only */
+typedef struct {
+    volatile uint32_t routed;   // Events forwarded into a department backlog
+    volatile uint32_t spilled;  // ... of which went to the department spill store
+    volatile uint32_t failed;   // Events failed because the department backlog was full
+    volatile uint32_t coalesced; // Duplicate reports merged into a live incident (not routed)
+    volatile uint32_t invalid;  // Events discarded - unknown event type / department not registered
+} DispatcherStats_t;
+
+extern DispatcherStats_t g_dispatcherStats[DISPATCHER_SHARDS];
 
 /* EventGroup bits */
 #define MGR_BIT_OVERLOAD            (1u << 0) // overload mode active
 
 
-/* If you have a global dept array, declare it extern here (recommended) */
-extern DepartmentDescription_t g_depts[EVENT_MAX];
-
 /**
- * @brief Receives events from UDP RX queue and forwards them to the appropriate department queue based on event type.
+ * @brief Receives events from the UDP RX lanes of its shard and forwards them to the appropriate department queue based on event type.
+ *        One instance per shard (DISPATCHER_SHARDS) - every shard owns a disjoint subset of departments (see DispatcherShardOf()),
+ *        so no two dispatchers route into the same department and per-department order is kept. The department spill
+ *        mutex is still shared with the vehicles and the manager of the department (see DepartmentDescription_t.spillMutex).
  * @attention This task priority is set to be higher than department tasks - Medium Level.
- * @param pvParameters Not used pointer.
+ * @param pvParameters Shard index (cast to pointer).
  */
 void Task_Dispatcher(void *pvParameters);
 
+/**
+ * @brief Routes one event into the backlog of its department (spill / fail policy of Dept_Enqueue()) and counts it
+ *        in the stats of the owning shard.
+ * @attention Called by the dispatcher of the owning shard, or by the Client UDP-RX task in fast path mode (FAST_PATH=1).
+ *            Only one task may route the events of a shard.
+ * @param event - Event to route
+ */
+void Dispatcher_Route(const EmergencyEvent_t *event);
+
 /**
  * @brief Monitors department queues and vehicle availability, and manages dispatching logic.
+ *        Event driven - sleeps on its task notification (Dept_SignalManager(): backlog thresholds, vehicle
+ *        start/finish) and wakes on its own only at policy deadlines (break idle time, mutual aid wait).
  * @attention This task priority is set to be higher than department tasks - Medium Level.
- * @param pvParameters Pointer to DepartmentDescription_t array.
+ * @param pvParameters Pointer to the department registry slot (DepartmentDescription_t).
  */
 void Task_Manager_Departments_X(void *pvParameters);
 
 /**
- * @brief Initializes department description table with queues, mutexes, and semaphores.
- * @param pvParameters Pointer to DepartmentDescription_t array.
+ * @brief Supervisor mode - one task runs the manager policies of every registered department.
+ *        Blocks on a queue set over one binary signal semaphore per department (Dept_SignalManager() gives it),
+ *        and runs the policies of whichever department was signalled or reached its policy deadline.
+ *        Policy state is kept per department, so the behaviour matches the per-department managers.
+ * @attention Create instead of the Task_Manager_Departments_X tasks (MANAGER_SUPERVISOR=1), after all departments are registered.
+ * @param pvParameters Not used pointer.
+ */
+void Task_Supervisor(void *pvParameters);
+
+/**
+ * @brief Checks the vehicle token ledger of every registered department (tokens are created with the fleet by Dept_Register).
+ * @attention Call after CreateClientDepartmentQueuesSemaphoresAndMutex().
  */
-void ClientDeptManager_Init(DepartmentDescription_t *pvParameters);
+void ClientDeptManager_Init(void);
 
 
 
@@ -0,0 +1,82 @@
+/**
+ * @file FleetStats.h
+ * @brief Fleet utilization: per-vehicle and per-department state-time accounting.
+ *        Every vehicle accounts the time it spends idle, waiting for a vehicle token and busy (travel + handling),
+ *        and the jobs it finished. Breaks are vehicle tokens held by the manager, so break time is accounted per
+ *        department as vehicle-time. A multi-vehicle job is served by one vehicle holding the tokens of its whole gang,
+ *        so the extra tokens are accounted as gang vehicle-time of that vehicle.
+ *        Break and gang tokens keep other vehicles from working, so the department report takes their vehicle-time out
+ *        of the fleet's idle (then waiting) time - busy + gang + idle + waiting + break add up to 100%.
+ *        Snapshots fold in the running interval, so they are exact at any moment. Reports cover the active fleet only,
+ *        the time a vehicle spent retired by the autoscaler (VEHICLE_RETIRED) is left out of its shares.
+ *        The managers export a report of their department every FLEET_STATS_REPORT_MS, including the fleet size
+ *        that would carry the measured busy time at FLEET_STATS_TARGET_UTIL_PCT (to right-size the *_VEHICLES knobs),
+ *        and the effective capacity from the vehicle token ledger - it must equal the fleet size, a report where it
+ *        does not is flagged as CAPACITY DRIFT.
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#ifndef FLEET_STATS_H
+#define FLEET_STATS_H
+
+#include "Shared_Configuration.h"
+
+/* --- Fleet utilization knobs --- */
+#ifndef FLEET_STATS_REPORT_MS
+#define FLEET_STATS_REPORT_MS          30000 /* period of the per-department utilization report (0 = off) */
+#endif
+#define FLEET_STATS_TARGET_UTIL_PCT    70    /* right-sizing: busy share a vehicle should run at */
+#define FLEET_STATS_VEHICLE_LINES      16    /* per-vehicle report lines only for fleets up to this size */
+
+/* Utilization snapshot of one department - sums over its fleet */
+typedef struct {
+    UBaseType_t vehicles;
+    uint64_t    ms[VEHICLE_ACTIVITY_MAX];   /* vehicle-time per activity */
+    uint64_t    breakMs;                    /* vehicle-time on break (tokens held by the manager) */
+    uint64_t    gangMs;                     /* extra vehicle-time of multi-vehicle jobs (tokens held beyond the serving vehicle) */
+    uint32_t    jobs;                       /* services finished by the fleet (own and mutual aid) */
+    UBaseType_t now[VEHICLE_ACTIVITY_MAX];  /* vehicles per activity right now */
+    UBaseType_t onBreak;                    /* tokens on break right now */
+    DeptLedger_t tokens;                    /* vehicle token ledger right now (Dept_Ledger) */
+    UBaseType_t capacity;                   /* effective capacity - tokens free in the semaphore or held, = vehicles unless drifted */
+} DeptStats_t;
+
+/**
+ * @brief Moves a vehicle to another activity and closes the time of the current one.
+ *        Leaving VEHICLE_BUSY counts a finished job, and the gang time of its extra tokens (v->units - 1).
+ * @attention Called by whoever drives the vehicle - its own task, or the service clock (SERVICE_CLOCK=1).
+ * @param v - Vehicle
+ * @param activity - New activity
+ */
+void FleetStats_SetActivity(VehicleState_t *v, VehicleActivity_t activity);
+
+/**
+ * @brief Records a change of the number of vehicle tokens held for breaks.
+ * @attention Called by the manager policies of the department (ManagerStep) whenever its break count may have changed.
+ * @param d - Department
+ * @param onBreak - Tokens held for breaks from now on
+ */
+void FleetStats_SetOnBreak(DepartmentDescription_t *d, UBaseType_t onBreak);
+
+/**
+ * @brief Snapshot of one vehicle's accounting, running interval included.
+ * @param v - Vehicle
+ * @param out - Output snapshot
+ */
+void FleetStats_Vehicle(const VehicleState_t *v, VehicleStats_t *out);
+
+/**
+ * @brief Snapshot of one department's accounting, running intervals included.
+ * @param d - Department
+ * @param out - Output snapshot
+ */
+void FleetStats_Dept(const DepartmentDescription_t *d, DeptStats_t *out);
+
+/**
+ * @brief Prints the utilization report of one department (and of its vehicles, for small fleets).
+ * @param d - Department
+ */
+void FleetStats_Report(const DepartmentDescription_t *d);
+
+#endif // FLEET_STATS_H
@@ -0,0 +1,41 @@
+/**
+ * @file Location.h
+ * @brief Location model of the Client: "Street N" (N = 0..99) is mapped to integer grid coordinates, and
+ *        the travel time between every pair of locations is precomputed once, so dispatch can look it up in O(1).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#ifndef LOCATION_H
+#define LOCATION_H
+
+#include "Shared_Configuration.h"
+
+/* --- Location model knobs --- */
+#define LOCATION_GRID_W         10      /* Street N lies at (N % W, N / W) */
+#define LOCATION_COUNT          100     /* Streets 0..99 */
+#define LOCATION_UNKNOWN        0xFFu   /* Location text could not be parsed */
+#define TRAVEL_MS_PER_BLOCK     500     /* Travel time per grid block (Manhattan distance) */
+#define TRAVEL_MS_UNKNOWN       2000    /* Travel time assumed when a location is unknown */
+
+/**
+ * @brief Precomputes the travel time matrix. Call once before any vehicle task runs.
+ */
+void Location_Init(void);
+
+/**
+ * @brief Parses an event location ("Street N").
+ * @param location - Location text of an EmergencyEvent_t
+ * @return uint8_t Location index 0..LOCATION_COUNT-1, or LOCATION_UNKNOWN.
+ */
+uint8_t Location_Parse(const char *location);
+
+/**
+ * @brief Travel time between two locations - one table load.
+ * @param from - Location index or LOCATION_UNKNOWN
+ * @param to - Location index or LOCATION_UNKNOWN
+ * @return uint32_t Travel time in ms.
+ */
+uint32_t Location_TravelMs(uint8_t from, uint8_t to);
+
+#endif // LOCATION_H
@@ -0,0 +1,71 @@
+/**
+ * @file MutualAid.h
+ * @brief Cross-department mutual aid: idle vehicles of one department serve events of a saturated department.
+ *        The capability matrix lists which department can serve which catalog items (by event detail) of another
+ *        department, and the service time penalty of doing so. A department manager raises aidWanted while its
+ *        backlog or waiting time is past the thresholds below, and idle helper vehicles pull eligible events
+ *        (most urgent first) from its backlog.
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#ifndef MUTUAL_AID_H
+#define MUTUAL_AID_H
+
+#include "Shared_Configuration.h"
+
+/* --- Mutual aid knobs --- */
+#ifndef MUTUAL_AID_ENABLE
+#define MUTUAL_AID_ENABLE          1     /* 0 = departments only serve their own events */
+#endif
+#define MUTUAL_AID_BACKLOG         4     /* backlog at which a department asks for aid */
+#define MUTUAL_AID_WAIT_MS         3000  /* ... or events waited this long with no free vehicle */
+#define MUTUAL_AID_POLL_MS         250   /* idle helper vehicles look for aid work this often */
+
+/* One row of the capability matrix */
+typedef struct {
+    EventType_t  owner;      // Department that owns the event
+    const char  *detail;     // Catalog item (event_detail) the helper can serve
+    EventType_t  helper;     // Department whose vehicles can serve it
+    uint8_t      penaltyPct; // Extra service time of the helper, in percent
+} MutualAidCapability_t;
+
+extern const MutualAidCapability_t mutualAidMatrix[];
+extern const uint32_t mutualAidMatrixCount;
+
+/**
+ * @brief Returns pdTRUE if the department appears as helper in the capability matrix.
+ * @param helper - Department
+ */
+BaseType_t MutualAid_IsHelper(const DepartmentDescription_t *helper);
+
+/**
+ * @brief Departments that may serve an event by mutual aid - for DeptJob_t.helpers, computed once on arrival.
+ *        A helper lends one vehicle, so multi-vehicle incidents stay with their owner (its gang reservation).
+ * @param event - Arriving event
+ * @return uint32_t Bit (1u << helper type) per matrix row matching the event type and detail, 0 = none.
+ */
+uint32_t MutualAid_Helpers(const EmergencyEvent_t *event);
+
+/**
+ * @brief Takes the most urgent event the helper can serve from the departments that want aid, most backlogged first -
+ *        the next one is tried when a backlog holds nothing the helper can serve (spilled events included).
+ * @attention Never blocks. The caller must already hold one of the helper's vehicle tokens.
+ * @param helper - Department of the idle vehicle
+ * @param job - Output job
+ * @param deadline - Output deadline tick the job was queued with (see Dept_OnServiceStart)
+ * @param penaltyPct - Output service time penalty in percent
+ * @return DepartmentDescription_t* Owner department of the event, or NULL if there is no eligible work.
+ */
+DepartmentDescription_t *MutualAid_Take(DepartmentDescription_t *helper, DeptJob_t *job,
+                                        uint32_t *deadline, uint8_t *penaltyPct);
+
+/**
+ * @brief Updates the aidWanted flag of a department - called by its manager on every cycle.
+ * @param d - Department
+ * @param backlog - Current backlog (queue + spill)
+ * @param saturatedSince - Manager state: tick the backlog started waiting with no free vehicle, 0 = not saturated
+ */
+void MutualAid_UpdateRequest(DepartmentDescription_t *d, UBaseType_t backlog, TickType_t *saturatedSince);
+
+#endif // MUTUAL_AID_H
@@ -1,12 +1,41 @@
 /**
  * @file Vehicle_Task.h
- * @brief This header file contains the different Department's Vehicle tasks.
- *        Thus task to simulates Department's Vehicles <-> Dispatcher communication. 
+ * @brief This header file contains the Department's Vehicle task.
+ *        Thus task to simulates Department's Vehicles <-> Dispatcher communication, one task instance per vehicle.
  *        Typical Task flows these logic:
- *             1) Wait for an event to exist (do NOT remove it yet) - use xQueuePeek to check the queue head.
- *             2) Get the resource semaphore for this department/type - use DeptSemFromType() to get the correct counting semaphore handle for this event type.
- *             3) Wait until a vehicle/resource is available (manager "break" will block us here) - use xSemaphoreTake on the counting semaphore to wait for availability.
- *             4) Remove the event from the queue (now that we know we can handle it) - use xQueueReceive to actually pull the event from the queue.
+ *             1) Wait for an event to exist (do NOT remove it yet) - use xPQueuePeek to check the department queue head.
+ *             2) Leave the event to the nearest idle vehicle of the department (claim-with-grace, see VEHICLE_CLAIM_GRACE_MS):
+ *                notify it, and sleep until the grace period ends or a notification makes us the nearest one.
+ *                A vehicle waiting at the reservation gate (step 3) is not idle - it cannot move before its tokens are free.
+ *             3) Wait until the vehicles the event needs are available (manager "break" will block us here) - use Dept_Reserve on the department tokens.
+ *             4) Remove the event from the queue (now that we know we can handle it) - the most urgent event the reservation covers.
+ *             5) Travel to the event location (see Location.h) and handle it.
+ *
+ *        Direct handoff mode (VEHICLE_HANDOFF=1) replaces steps 1-4: an idle vehicle parks on the idle stack of its
+ *        department and sleeps on its mailbox notification. Vehicle_Handoff() pops the idle vehicle nearest to the head
+ *        event, moves the event into that vehicle's mailbox and notifies it - every event wakes exactly one vehicle.
+ *
+ *        Service clock mode (SERVICE_CLOCK=1) has no vehicle tasks at all: vehicles are plain VehicleState_t records
+ *        and a single Task_ServiceClock keeps a min-heap of their service completion times. Events are handed to idle
+ *        records like in handoff mode, the clock journals the completion when the service time (travel + handling)
+ *        has passed. City-scale fleets (FLEET_SCALE) then cost memory, not host threads.
+ *
+ *        Multi-vehicle incidents (catalog units > 1): the vehicle that takes the event reserves the tokens of the whole
+ *        gang at once with Dept_Reserve() - all or nothing, in FIFO order behind the department gate, so a large incident
+ *        is never starved by single-vehicle events. The gang tokens are held for the whole service, like break tokens.
+ *        Handoff and service clock modes never wait for tokens: there the head gang collects them as they free up
+ *        (Dept_ReserveHold()), and the department lends no vehicle to mutual aid while its own backlog waits.
+ *
+ *        Preemption (PREEMPT_ENABLE): a critical event that finds no free vehicle token takes the vehicle serving the
+ *        lowest-priority job of its department. Vehicle_Preempt() aborts that vehicle's service delay (xTaskAbortDelay),
+ *        the job goes back to its backlog with its remaining handling time and original deadline, and the vehicle takes
+ *        the critical event. While any vehicle serves a less urgent job, a critical event never waits for a service to end.
+ *        Gangs are left out: their jobs are never preempted and a critical multi-vehicle event waits at the reservation gate.
+ *
+ *        Autoscaling (AUTOSCALE_ENABLE): fleet[0..vehicles-1] is the active fleet, the slots up to maxVehicles are spares.
+ *        The manager grows the fleet with Vehicle_Activate() (one vehicle token more, the spare's task is created on first
+ *        use) and shrinks it with Vehicle_Retire() after destroying a token (Dept_FleetShrink). A retired vehicle finishes its job and
+ *        parks - on its task notification, or off the idle stack in service clock mode - until the fleet grows again.
  * 
  * @attention Task_TestVehicle was only used for testing.
  * @attention This task priority is set to be lower than Dispatcher task priority - Low Level.
@@ -15,47 +44,104 @@
 #ifndef VEHICLE_TASK_H
 #define VEHICLE_TASK_H
 
+#include "Shared_Configuration.h"
+
+/* --- Direct handoff mode (make VEHICLE_HANDOFF=1) --- */
+#ifndef VEHICLE_HANDOFF
+#define VEHICLE_HANDOFF          0
+#endif
+#define VEHICLE_MAILBOX_INDEX    1    /* task notification index of the vehicle mailbox (configTASK_NOTIFICATION_ARRAY_ENTRIES) */
+
+/* --- Service clock mode (make SERVICE_CLOCK=1) - vehicles are records, not tasks --- */
+#ifndef SERVICE_CLOCK
+#define SERVICE_CLOCK            0
+#endif
+#if SERVICE_CLOCK
+#undef  VEHICLE_HANDOFF
+#define VEHICLE_HANDOFF          1    /* events reach the vehicle records through Vehicle_Handoff() */
+#endif
+
+/* --- Preemption knobs --- */
+#ifndef PREEMPT_ENABLE
+#define PREEMPT_ENABLE           1    /* 0 = a started job always runs to completion */
+#endif
+#define PREEMPT_PRIORITY_MIN     EVENT_PRIORITY_MAX /* events of this priority may preempt less urgent jobs */
+
+#define VEHICLE_TASK_PRIORITY    (tskIDLE_PRIORITY + 1) /* vehicle tasks - below the dispatcher (main.c LOW_PRIORITY) */
+
+/* --- Nearest vehicle dispatch knobs --- */
+#define VEHICLE_CLAIM_GRACE_MS   200  /* a vehicle that is not the nearest idle one waits this long before taking the head event */
+#define VEHICLE_CLAIM_INDEX      VEHICLE_MAILBOX_INDEX /* pull mode - "head event is yours" notification (no mailbox in pull mode) */
+
 /**
  * @brief This task is for testing purposes only.
  * @param pvParameters 
  */
 void Task_TestVehicle(void *pvParameters);
 
-
 /**
- * @brief This task to simulates Ambulance <-> Dispatcher communication.
- * @param pvParameters 
+ * @brief This task to simulates Vehicle <-> Dispatcher communication of any department.
+ * @param pvParameters Pointer to the vehicle state (VehicleState_t in its department fleet).
  */
-void Task_Ambulance_X(void *pvParameters);
+void Task_Vehicle(void *pvParameters);
 
 /**
- * @brief This task to simulates Police <-> Dispatcher communication.
- * @param pvParameters Not used pointer.
+ * @brief Service clock - runs the whole vehicle fleet of every registered department without a task per vehicle.
+ *        Sleeps until the earliest service completion (or a new earlier one), then journals the completions that
+ *        are due and hands waiting events to the vehicles that became idle. A burst of completions larger than the
+ *        journal ring goes to its overflow tier - the clock never blocks on the journal and never drops a completion.
+ * @attention Only used in service clock mode (SERVICE_CLOCK=1). Create instead of the Task_Vehicle tasks,
+ *            after all departments are registered.
+ * @param pvParameters - Not used
  */
-void Task_Police_X(void *pvParameters);
+void Task_ServiceClock(void *pvParameters);
 
 /**
- * @brief This task to simulates Fire Department <-> Dispatcher communication.
- * @param pvParameters 
+ * @brief Direct handoff - delivers head events of the department backlog to idle vehicles, one vehicle per event,
+ *        while there are events, idle vehicles and free vehicle tokens (vehicles on break keep their token).
+ *        A multi-vehicle head event takes the tokens of its whole gang or waits - events behind it never overtake it.
+ *        While it waits, the free tokens stay held for it (Dept_ReserveHold()), the hold is given back once the
+ *        backlog is empty.
+ *        The idle vehicle nearest to the event location gets it (most recently idle on ties).
+ * @attention Only used in handoff mode (VEHICLE_HANDOFF=1, implied by SERVICE_CLOCK=1). Called by the dispatcher after
+ *            an enqueue, by vehicles that become idle (by the service clock in its mode) and by the manager after
+ *            returning vehicles from break. Safe to call concurrently.
+ * @param d - Department
+ * @return UBaseType_t Number of events handed off.
  */
-void Task_Fire_X(void *pvParameters);
+UBaseType_t Vehicle_Handoff(DepartmentDescription_t *d);
 
 /**
- * @brief This task to simulates Maintenance <-> Dispatcher communication.
- * @param pvParameters 
+ * @brief Preemption - if a critical event of the department finds no free vehicle token, the vehicle serving the
+ *        lowest-priority job (nearest to the critical event on ties) gives its job back and takes a critical event.
+ *        Vehicle tasks are woken from their service delay with xTaskAbortDelay(), vehicle records of the service
+ *        clock switch jobs right away.
+ * @attention Only used with PREEMPT_ENABLE=1. Called by the dispatcher after the critical event is enqueued.
+ *            Every call preempts at most one vehicle.
+ * @param d - Department
+ * @param critical - Critical event that was just enqueued (priority >= PREEMPT_PRIORITY_MIN)
+ * @return BaseType_t pdTRUE if a vehicle was preempted.
  */
-void Task_Maintenance_X(void *pvParameters);
+BaseType_t Vehicle_Preempt(DepartmentDescription_t *d, const EmergencyEvent_t *critical);
 
 /**
- * @brief This task to simulates Waste Collection <-> Dispatcher communication.
- * @param pvParameters 
+ * @brief Autoscaling - adds the next spare vehicle to the active fleet of the department and creates its vehicle token (Dept_FleetGrow).
+ *        A vehicle that was retired but is still finishing its job simply stays, a parked one is woken (or put back
+ *        on the idle stack in service clock mode), a spare that never ran gets its task created.
+ * @attention Called by the department manager only (ManagerStep), one caller per department.
+ * @param d - Department
+ * @return BaseType_t pdTRUE if the fleet grew, pdFALSE at maxVehicles (or if the vehicle task could not be created).
  */
-void Task_Waste_X(void *pvParameters);
+BaseType_t Vehicle_Activate(DepartmentDescription_t *d);
 
 /**
- * @brief This task to simulates Electricity Department <-> Dispatcher communication.
- * @param pvParameters
+ * @brief Autoscaling - removes the last vehicle of the active fleet. An idle vehicle parks right away, a busy one
+ *        once its job is done. Pull mode vehicles park the next time they look at the backlog.
+ * @attention Called by the department manager only (ManagerStep), after destroying one vehicle token with Dept_FleetShrink()
+ *            (a free one, or one held for a break) - the capacity shrinks with the token, not with the vehicle.
+ * @param d - Department
+ * @return BaseType_t pdTRUE if the fleet shrank, pdFALSE at minVehicles.
  */
-void Task_Electricity_X(void *pvParameters);
+BaseType_t Vehicle_Retire(DepartmentDescription_t *d);
 
-#endif // VEHICLE_TASK_H
\ No newline at end of file
+#endif // VEHICLE_TASK_H
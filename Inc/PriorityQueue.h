@@ -0,0 +1,110 @@
+/**
+ * @file PriorityQueue.h
+ * @brief Priority-ordered queue primitive with the blocking semantics of a FreeRTOS queue.
+ *        Items are copied in and out like xQueueSend / xQueueReceive, but every item carries a key and
+ *        receive always returns the most urgent item (smallest key, oldest first on equal keys).
+ *        The least urgent item (largest key, newest first on equal keys) can be removed in O(log n) as well.
+ *
+ *        Implementation: twin binary heaps (min-heap + max-heap) over one slot pool, so send, receive
+ *        and remove-lowest are all O(log n). Blocking uses two counting semaphores (items / free spaces).
+ *
+ * @attention Used by the Client department backlogs (see Shared_Configuration.h).
+ */
+
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Handle of a priority queue - opaque */
+typedef struct PQueueDefinition *PQueueHandle_t;
+
+/* Item filter for xPQueueReceiveIf - returns pdTRUE if the item may be taken.
+   Called inside a critical section, so it must be short and must not block. */
+typedef BaseType_t (*PQueuePredicate_t)(const void *pvItem, void *pvContext);
+
+/**
+ * @brief Creates a priority queue.
+ * @param uxLength - Max number of items
+ * @param uxItemSize - Size of one item in bytes
+ * @return PQueueHandle_t Handle on success, NULL if allocation failed.
+ */
+PQueueHandle_t xPQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize);
+
+/**
+ * @brief Deletes a priority queue and frees its memory.
+ * @attention No task may be blocked on the queue.
+ * @param xPQueue - Queue to delete
+ */
+void vPQueueDelete(PQueueHandle_t xPQueue);
+
+/**
+ * @brief Copies an item into the queue.
+ * @param xPQueue - Queue to send to
+ * @param pvItem - Item to copy
+ * @param ulKey - Ordering key, smaller = more urgent (equal keys keep FIFO order).
+ *                Keys are compared wrap-safe like ticks, so all keys in a queue must lie within 2^31 of each other.
+ * @param xTicksToWait - Max time to wait for space in the queue
+ * @return BaseType_t pdPASS on success, errQUEUE_FULL if the queue stayed full.
+ */
+BaseType_t xPQueueSend(PQueueHandle_t xPQueue, const void *pvItem, uint32_t ulKey, TickType_t xTicksToWait);
+
+/**
+ * @brief Removes the most urgent item from the queue.
+ * @param xPQueue - Queue to receive from
+ * @param pvItem - Output item
+ * @param pulKey - Output key of the item (can be NULL)
+ * @param xTicksToWait - Max time to wait for an item
+ * @return BaseType_t pdPASS on success, pdFAIL if the queue stayed empty.
+ */
+BaseType_t xPQueueReceive(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait);
+
+/**
+ * @brief Copies the most urgent item without removing it. A non-empty queue is read without taking the item count,
+ *        so the peek never makes a concurrent receiver find the queue empty.
+ * @param xPQueue - Queue to peek
+ * @param pvItem - Output item
+ * @param pulKey - Output key of the item (can be NULL)
+ * @param xTicksToWait - Max time to wait for an item
+ * @return BaseType_t pdPASS on success, pdFAIL if the queue stayed empty.
+ */
+BaseType_t xPQueuePeek(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait);
+
+/**
+ * @brief Removes the least urgent item from the queue (never blocks).
+ * @param xPQueue - Queue to remove from
+ * @param pvItem - Output item
+ * @param pulKey - Output key of the item (can be NULL)
+ * @return BaseType_t pdPASS on success, pdFAIL if the queue is empty.
+ */
+BaseType_t xPQueueRemoveLowest(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey);
+
+/**
+ * @brief Removes the most urgent item that satisfies a predicate (never blocks).
+ *        O(n) scan of the queue - meant for occasional work stealing, not for the hot path.
+ * @param xPQueue - Queue to receive from
+ * @param pvItem - Output item
+ * @param pulKey - Output key of the item (can be NULL)
+ * @param xPredicate - Filter, see PQueuePredicate_t
+ * @param pvContext - Passed to the predicate
+ * @return BaseType_t pdPASS on success, pdFAIL if no item satisfies the predicate.
+ */
+BaseType_t xPQueueReceiveIf(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey,
+                            PQueuePredicate_t xPredicate, void *pvContext);
+
+/**
+ * @brief Number of items in the queue.
+ * @param xPQueue - Queue to query
+ * @return UBaseType_t Number of waiting items.
+ */
+UBaseType_t uxPQueueMessagesWaiting(PQueueHandle_t xPQueue);
+
+/**
+ * @brief Number of free spaces in the queue.
+ * @param xPQueue - Queue to query
+ * @return UBaseType_t Number of free spaces.
+ */
+UBaseType_t uxPQueueSpacesAvailable(PQueueHandle_t xPQueue);
+
+#endif // PRIORITY_QUEUE_H
@@ -41,6 +41,7 @@ void Db_InsertEventPending(const EmergencyEvent_t *e);
  * @brief Update an event's status in the database after receiving a completion message.
  * @attention This function uses a mutex to ensure thread-safe access to the database.
  * @attention This function checks for DB initialization and valid input.
+ * @attention msg->timestampEnd is expected on the server timeline (see ServerUDP_ClientToServerTicks).
  * @param msg - Pointer to CompletionMsg_t structure containing completion details.
  */
 void Db_UpdateEventCompletion(const CompletionMsg_t *msg);
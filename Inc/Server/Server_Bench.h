@@ -0,0 +1,46 @@
+/**
+ * @file Server_Bench.h
+ * @brief Transport-only benchmark (build with: make TRANSPORT_BENCH=1).
+ *        The Server drives events at a configurable rate through the QoS lanes and UDP, the Client only
+ *        runs vClientEchoTask (no dispatcher, managers or vehicles), and the round trip of every event is
+ *        measured on the Server clock. Latency percentiles and throughput are printed every BENCH_REPORT_MS.
+ *        In ramp mode the rate is doubled while the transport keeps up, to find its max sustainable rate.
+ *        Every report also shows the process context switches per completed event (getrusage).
+ *        Build once as is and once with FAST_PATH=1 to compare the queued pipeline against the hop-free fast path.
+ *
+ * @attention This file is part of the server module.
+ */
+
+#ifndef SERVER_BENCH_H
+#define SERVER_BENCH_H
+
+#include "Shared_Configuration.h"
+
+/* --- Benchmark knobs (can be overridden from make, e.g. BENCH_RATE_HZ=2000) --- */
+#ifndef BENCH_RATE_HZ
+#define BENCH_RATE_HZ                500     /* start event rate */
+#endif
+#ifndef BENCH_RAMP
+#define BENCH_RAMP                   1       /* 1 = double the rate while sustained, 0 = fixed rate */
+#endif
+#define BENCH_MAX_RATE_HZ            128000  /* ramp stops here */
+#define BENCH_REPORT_MS              2000    /* report / ramp step period */
+#define BENCH_P99_LIMIT_US           20000   /* a step is sustained only if p99 stays under this */
+#define BENCH_LOSS_LIMIT_PERMILLE    10      /* ... and at most this many events per 1000 are lost */
+#define BENCH_INFLIGHT_MAX           65536   /* send time slots, indexed by event id (power of two) */
+
+/**
+ * @brief Task that generates events at the benchmark rate and prints the periodic report.
+ *        Replaces Task_EventGenerator in benchmark mode (events are not written to the DataBase).
+ * @param pvParameters - Not used
+ */
+void Task_BenchGenerator(void *pvParameters);
+
+/**
+ * @brief Records the round trip of a completed event.
+ * @attention Called by vServerUDPRxTask for every completion in benchmark mode.
+ * @param msg - Completion message received from the client
+ */
+void ServerBench_OnCompletion(const CompletionMsg_t *msg);
+
+#endif // SERVER_BENCH_H
@@ -15,6 +15,7 @@ typedef struct {
     uint8_t      priority;     // Derived priority for this event info
     const char  *detail;       // Event detail text
     uint8_t      delayFactor;  // Delay factor for event handling simulation
+    uint8_t      units;        // Vehicles the incident needs at once (multi-vehicle incidents > 1)
 } EventCatalogItem_t;
 
 /* Event Catalog Array and Count - Used in the event generator */
@@ -11,6 +11,8 @@
 
 #include <stdint.h>
 
+#include "Shared_Configuration.h" // for EmergencyEvent_t
+
 /**
  * @brief Initializes the UDP server by creating and binding a socket to the predefined server port.
  *        It is used by the server tasks to communicate with the client over UDP on the same PORT.
@@ -37,6 +39,16 @@ int ServerUDP_GetSocket(void);
  */
 void vServerUDPTxTask(void *pvParameters);
 
+/**
+ * @brief Sends one event straight to the client that owns it, from the calling task (no UDP-TX lanes / task hop).
+ *        Used by the event generators in fast path mode (FAST_PATH=1).
+ * 
+ * @attention Should be called after ServerUDP_Init() is called.
+ * @param event - Event to send
+ * @return BaseType_t pdPASS on success, pdFAIL if no client is registered or sendto failed.
+ */
+BaseType_t ServerUDP_SendEvent(const EmergencyEvent_t *event);
+
 /**
  * @brief This task handles receiving CompletionMsg_t messages via UDP from the client.
  *        It receives messages from the network and sends them to a queue.
@@ -46,5 +58,71 @@ void vServerUDPTxTask(void *pvParameters);
  */
 void vServerUDPRxTask(void *pvParameters);
 
+/**
+ * @brief This task periodically sends HeartbeatMsg_t requests to the client.
+ *        The client echoes them back with its own receive/transmit ticks and vServerUDPRxTask
+ *        uses the reply to estimate RTT and Server <-> Client clock offset (NTP-style).
+ * 
+ * @attention This task should be created after ServerUDP_Init() is called.
+ * @param pvParameters - Not used
+ */
+void vServerHeartbeatTask(void *pvParameters);
+
+/**
+ * @brief Adds a client instance (regional dispatch center) to the server membership.
+ *        Events are routed to members by consistent hashing (see SHARD_KEY), so adding a member
+ *        only moves the keys it takes over.
+ * 
+ * @attention Can be called before or after the scheduler is started.
+ * @param ip - Client IPv4 address as text
+ * @param port - Client UDP port
+ * @return int Client index, or -1 if the address is invalid or the membership is full (UDP_MAX_CLIENTS).
+ */
+int ServerUDP_AddClient(const char *ip, uint16_t port);
+
+/**
+ * @brief Removes a client instance from the server membership.
+ *        Its keys move to the next members on the hash ring.
+ * 
+ * @param ip - Client IPv4 address as text
+ * @param port - Client UDP port
+ * @return int Index the client had, or -1 if it was not a member.
+ */
+int ServerUDP_RemoveClient(const char *ip, uint16_t port);
+
+/**
+ * @brief Picks the member that owns an event on the consistent hash ring.
+ * 
+ * @param event - Event to route (location or type is used as key, see SHARD_KEY)
+ * @return int Client index, or -1 if there are no members.
+ */
+int ServerUDP_RouteEvent(const EmergencyEvent_t *event);
+
+/**
+ * @brief Retrieves the current clock offset estimation of a client (client ticks - server ticks).
+ *        The value is taken from the minimum RTT sample of the last HEARTBEAT_FILTER_LEN heartbeats.
+ * 
+ * @param client - Client index
+ * @return int32_t Offset in ticks, or 0 if no heartbeat reply was received yet.
+ */
+int32_t ServerUDP_GetClockOffset(int client);
+
+/**
+ * @brief Retrieves the RTT of the heartbeat sample currently used for a client clock offset.
+ * 
+ * @param client - Client index
+ * @return uint32_t RTT in ticks, or 0 if no heartbeat reply was received yet.
+ */
+uint32_t ServerUDP_GetRtt(int client);
+
+/**
+ * @brief Maps a client tick count (e.g. CompletionMsg_t.timestampEnd) onto the server timeline.
+ * 
+ * @param client - Client index (unknown clients, -1, are mapped with offset 0)
+ * @param clientTicks - Tick count taken by the client scheduler
+ * @return uint32_t The same instant expressed in server ticks.
+ */
+uint32_t ServerUDP_ClientToServerTicks(int client, uint32_t clientTicks);
+
 
 #endif // SERVER_UDP_H
\ No newline at end of file
@@ -23,6 +23,8 @@
 #include "queue.h"
 #include "semphr.h"
 
+#include "PriorityQueue.h" // Department backlogs
+
 /* -------Global Delay Definitions------ */
 
 #define Short_Delay_MS                 10   // 10 ms
@@ -30,20 +32,67 @@
 #define Long_Delay_MS                  500  // 500 ms
 #define baseEventHandling_Delay_MS     1000 // 1 second
 
+/* -------Transport benchmark mode (make TRANSPORT_BENCH=1)------- */
+
+#ifndef TRANSPORT_BENCH
+#define TRANSPORT_BENCH     0   // 1 = Client runs only the echo path, Server drives a configurable event rate
+#endif
+
+/* -------Fast path mode (make FAST_PATH=1)------- */
+
+#ifndef FAST_PATH
+#define FAST_PATH           0   // 1 = hop elimination: the Server generator writes straight to the socket (no UDP-TX lanes/task)
+                                //     and the Client UDP-RX task routes straight into the department queues (no RX lanes/dispatchers)
+#endif
+
+/* Per-event log lines on the UDP/queue path - compiled out in benchmark mode so printf does not dominate */
+#if TRANSPORT_BENCH
+#define TRANSPORT_LOG(...)  ((void)0)
+#else
+#define TRANSPORT_LOG(...)  printf(__VA_ARGS__)
+#endif
+
 /* -------UDP Setup------- */
 
 #define UDP_IP_Addr          "127.0.0.1" // Loopback IP 
 #define UDP_SERVER_PORT      5000   // Server PORT 
-#define UDP_CLIENT_PORT      5001   // Client PORT
+#define UDP_CLIENT_PORT      5001   // Client PORT (default member and default client bind port)
+
+/* -------Client Sharding Setup (Server -> K Clients)------- */
+
+#define UDP_MAX_CLIENTS      8      // Max client instances (regional dispatch centers) per server
+#define SHARD_VNODES         16     // Virtual nodes per client on the consistent hash ring
+#define SHARD_BY_LOCATION    0      // Route by hash of event location
+#define SHARD_BY_TYPE        1      // Route by hash of event type
+#ifndef SHARD_KEY
+#define SHARD_KEY            SHARD_BY_LOCATION
+#endif
+
+/* -------Heartbeat Setup (Server <-> Client clock sync)------- */
+
+#define HEARTBEAT_INTERVAL_MS    1000        // Period of Server heartbeat requests
+#define HEARTBEAT_FILTER_LEN     8           // Samples kept for the min-RTT clock filter
+#define HEARTBEAT_MAGIC          0x48425431u // "HBT1" - marks a heartbeat datagram
 
 /* Additional configuration for client tasks */
 #define MAX_COUNTING_SEMAPHORE     5 // Max count for counting semaphore
-#define AMBULANCE_VEHICLES         3 // Number of Ambulance vehicles
-#define POLICE_VEHICLES            5 // Number of Police vehicles
-#define FIRE_VEHICLES              2 // Number of Fire Department vehicles
-#define MAINTENANCE_VEHICLES       1 // Number of Maintenance vehicles
-#define WASTE_VEHICLES             2 // Number of Waste Collection vehicles
-#define ELECTRICITY_VEHICLES       1 // Number of Electricity vehicles
+#ifndef FLEET_SCALE
+#define FLEET_SCALE                1 // Multiplies every fleet - city-scale runs, best with SERVICE_CLOCK=1 (see Vehicle_Task.h)
+#endif
+#define AMBULANCE_VEHICLES         (3 * FLEET_SCALE) // Number of Ambulance vehicles
+#define POLICE_VEHICLES            (5 * FLEET_SCALE) // Number of Police vehicles
+#define FIRE_VEHICLES              (2 * FLEET_SCALE) // Number of Fire Department vehicles
+#define MAINTENANCE_VEHICLES       (1 * FLEET_SCALE) // Number of Maintenance vehicles
+#define WASTE_VEHICLES             (2 * FLEET_SCALE) // Number of Waste Collection vehicles
+#define ELECTRICITY_VEHICLES       (1 * FLEET_SCALE) // Number of Electricity vehicles
+
+/* Fleet autoscaling (make AUTOSCALE_ENABLE=0 for fixed fleets) - every fleet starts at its *_VEHICLES size and the
+   department manager grows / shrinks it within these bounds (see DispatcherAndMangerDepartment_Task.h) */
+#ifndef AUTOSCALE_ENABLE
+#define AUTOSCALE_ENABLE           1
+#endif
+#define FLEET_MIN_PCT              50  // Smallest fleet in percent of the configured size (at least 1 vehicle)
+#define FLEET_MAX_PCT              200 // Largest fleet in percent of the configured size
 
 
 
@@ -60,13 +109,32 @@ typedef enum {
     EVENT_MAX
 } EventType_t;
 
+#define EVENT_PRIORITY_MAX  3 // Highest event priority (High)
+
+/* Response-time targets per event priority (arrival at the department -> a vehicle starts handling).
+   Department backlogs are ordered earliest-deadline-first, so an old Low event ages past newer High ones. */
+#define DEADLINE_HIGH_MS     10000  // 10 seconds
+#define DEADLINE_MEDIUM_MS   60000  // 1 minute
+#define DEADLINE_LOW_MS      180000 // 3 minutes
+
+/* Time-to-live per event priority (entry into the department backlog -> expiry), 0 = never expires.
+   An event still waiting in its department backlog past its TTL is dropped with STATUS_EXPIRED instead of taking a
+   vehicle - when the vehicle taking it dequeues it, or by the manager sweep (EVENT_TTL_SWEEP_MS). */
+#ifndef EVENT_TTL_ENABLE
+#define EVENT_TTL_ENABLE     1
+#endif
+#define TTL_HIGH_MS          0      // Critical work is always worth a vehicle
+#define TTL_MEDIUM_MS        300000 // 5 minutes
+#define TTL_LOW_MS           600000 // 10 minutes
+
 /* Structure for emergency event from server to client */
 typedef struct {
     uint32_t eventID;
     EventType_t type; // EventType_t enum (1=Ambulance, 2=Police, etc.)
     char event_detail[64]; // Detailed event description - New field added!
-    uint8_t priority; // 1=Low, 2=Medium, 3=High
+    uint8_t priority; // 1=Low, 2=Medium, 3=High (EVENT_PRIORITY_MAX)
     uint8_t delayFactor; // Delay factor for event handling simulation - New field added!
+    uint8_t units; // Vehicles the incident needs at once (gang allocation, see Dept_Reserve) - New field added!
     char location[32];
     uint32_t timestampStart;
 } EmergencyEvent_t;
@@ -76,62 +144,517 @@ typedef struct {
     uint32_t eventID;
     char handledBy[16]; // Department that handled the event
     uint32_t timestampEnd;
-    uint8_t status; // 1 = Success, 0 = Failed
+    uint8_t status; // STATUS_xxx below
 } CompletionMsg_t;
 
+/* Completion status codes (CompletionMsg_t.status) - and the server DB row status, which starts as STATUS_PENDING */
+#define STATUS_SUCCESS      0 // Handled by a vehicle
+#define STATUS_CANCELLED    1 // Cancelled by the department manager (overload policy)
+#define STATUS_FAILED       2 // Not handled - department queue and spill store were full
+#define STATUS_COALESCED    3 // Duplicate report - merged into the live incident of the same type, item and location
+#define STATUS_EXPIRED      4 // Waited in the department backlog past its TTL - dropped before dispatch
+#define STATUS_PENDING      255 // Server only - row inserted, no completion received yet (never sent by the client)
+
+
+/* Batch of completion messages coalesced in one datagram from client to server.
+   Only the first 'count' items are sent: datagram size = offsetof(items) + count * sizeof(CompletionMsg_t) */
+#define COMPLETION_BATCH_MAX     16          // Max completions per datagram
+#define COMPLETION_BATCH_MAGIC   0x43424154u // "CBAT" - marks a completion batch datagram
+typedef struct {
+    uint32_t magic; // COMPLETION_BATCH_MAGIC
+    uint32_t count; // Number of valid items
+    CompletionMsg_t items[COMPLETION_BATCH_MAX];
+} CompletionBatch_t;
+
+/* Structure for heartbeat exchange between server and client (NTP-style)
+   t1/t4 are server ticks, t2/t3 are client ticks - t4 is taken on reception and never sent */
+typedef struct {
+    uint32_t magic; // HEARTBEAT_MAGIC
+    uint32_t seq; // Heartbeat sequence number
+    uint32_t t1; // Server tick when request was sent
+    uint32_t t2; // Client tick when request was received
+    uint32_t t3; // Client tick when reply was sent
+} HeartbeatMsg_t;
+
 
 /* --------Queues (Server <-> Client)------- */
 
-#define SERVER_UDP_TX_LEN   16  // Length of Server UDP TX Queue
+#define SERVER_UDP_TX_LEN   16  // Length of each Server UDP TX QoS lane
 #define SERVER_UDP_RX_LEN   16  // Length of Server UDP RX Queue
-#define CLIENT_UDP_RX_LEN   16  // Length of Client UDP RX Queue
-#define CLIENT_UDP_TX_LEN   16  // Length of Client UDP TX Queue
+#define CLIENT_UDP_RX_LEN   16  // Length of each Client UDP RX QoS lane
+#define COMPLETION_JOURNAL_LEN  256 // Ring slots of the Client completion journal (replaces the Client UDP TX Queue) - overflow goes to the heap
+
+/* --------QoS Lanes (per-priority queues for EmergencyEvent_t)------- */
+
+#define QOS_LANE_HIGH           0   // Lane for critical events (priority >= QOS_HIGH_PRIORITY_MIN)
+#define QOS_LANE_NORMAL         1   // Lane for all other events
+#define QOS_LANES               2   // Number of lanes
+#define QOS_HIGH_PRIORITY_MIN   3   // Event priority that goes to the high lane (3=High)
+#define QOS_HIGH_BURST          8   // Weighted order: after this many high items in a row, serve one normal item
+
+/* Set of per-priority queues serviced in weighted-strict order.
+   'pending' counts the items over all lanes so a receiver can block on all lanes at once. */
+typedef struct {
+    QueueHandle_t       lane[QOS_LANES];
+    SemaphoreHandle_t   pending;    /* counting sem = items waiting over all lanes */
+    UBaseType_t         highBurst;  /* high lane items served in a row */
+} QosLanes_t;
+
+/* --------Dispatcher shards (Client UDP-RX -> Dispatchers)------- */
+
+#ifndef DISPATCHER_SHARDS
+#define DISPATCHER_SHARDS   2   // Dispatcher tasks - shard N owns the departments with type % DISPATCHER_SHARDS == N
+#endif
 
 /* Queue handles - extern in order to use in both server and client */
-extern QueueHandle_t handle_serverUDPTxQ;  /* use for EmergencyEvent_t */
+extern QosLanes_t    lanes_serverUDPTx;    /* use for EmergencyEvent_t */
 extern QueueHandle_t handle_serverUDPRxQ;  /* use for CompletionMsg_t  */
-extern QueueHandle_t handle_clientUDPRxQ;  /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_clientUDPTxQ;  /* use for CompletionMsg_t  */
+extern QosLanes_t    lanes_clientUDPRx[DISPATCHER_SHARDS]; /* use for EmergencyEvent_t - one set of lanes per dispatcher shard */
+
+/**
+ * @brief Maps an event type to the dispatcher shard that owns its department.
+ *        Shards own disjoint department subsets, so no two dispatchers ever route into the same department.
+ * @param type - EmergencyEvent_t type field
+ * @return UBaseType_t Shard index (0..DISPATCHER_SHARDS-1).
+ */
+static inline UBaseType_t DispatcherShardOf(EventType_t type)
+{
+    return (UBaseType_t)((unsigned)type % DISPATCHER_SHARDS);
+}
+
+/**
+ * @brief Maps an event priority (1=Low ... 3=High) to its QoS lane.
+ * @param priority - EmergencyEvent_t priority field
+ * @return UBaseType_t QOS_LANE_HIGH or QOS_LANE_NORMAL.
+ */
+UBaseType_t QosLaneFromPriority(uint8_t priority);
+
+/**
+ * @brief Sends an EmergencyEvent_t to the lane matching its priority.
+ * @param lanes - Lanes to send to
+ * @param event - Event to copy into the lane
+ * @param xTicksToWait - Max time to wait for space in the lane
+ * @return BaseType_t pdPASS on success, errQUEUE_FULL if the lane stayed full.
+ */
+BaseType_t QosLanes_Send(QosLanes_t *lanes, const EmergencyEvent_t *event, TickType_t xTicksToWait);
+
+/**
+ * @brief Receives the next EmergencyEvent_t from the lanes.
+ *        The high lane is served first, but after QOS_HIGH_BURST high items in a row one normal item
+ *        is served (if waiting) so normal traffic is never fully starved.
+ * @param lanes - Lanes to receive from
+ * @param event - Output event
+ * @param xTicksToWait - Max time to wait for an item in any lane
+ * @return BaseType_t pdPASS on success, pdFAIL on timeout.
+ */
+BaseType_t QosLanes_Receive(QosLanes_t *lanes, EmergencyEvent_t *event, TickType_t xTicksToWait);
+
+/**
+ * @brief Number of events waiting over all lanes.
+ * @param lanes - Lanes to query
+ * @return UBaseType_t Number of waiting events.
+ */
+UBaseType_t QosLanes_MessagesWaiting(const QosLanes_t *lanes);
+
+
+/* --------Department Registry (Dispatcher <-> Departments)-------- */
+
+#define DEPT_Q_LEN          16 // Length of each Department Queue
+#define DEPT_REGISTRY_MAX   16 // Registry slots - types EVENT_MAX..DEPT_REGISTRY_MAX-1 are free for runtime departments
+
+/* Spill store - elastic overflow tier behind a full department queue */
+#define DEPT_SPILL_CHUNK    16  // First allocation of the spill store, doubled on every growth
+#ifndef DEPT_SPILL_CAP
+#define DEPT_SPILL_CAP      256 // Hard cap of spilled events per department - beyond it events fail
+#endif
+
+/* Department backlog entry - an event plus the client-side state of its job, which never goes on the wire */
+typedef struct {
+    EmergencyEvent_t event;
+    uint32_t remainingMs; // Handling time left of a preempted job (0 = not started yet)
+    uint32_t expiresAt;   // TTL expiry tick (0 = never, see Dept_EventExpiry) - stamped by Dept_Enqueue()
+    uint32_t helpers;     // Mutual aid - bit (1u << type) per department that may serve it (DEPT_REGISTRY_MAX <= 32)
+} DeptJob_t;
+
+/* Spilled job with its department queue key */
+typedef struct {
+    uint32_t key;
+    uint32_t seq;       // Spill order - breaks ties between equal keys
+    DeptJob_t job;
+} DeptSpillItem_t;
+
+/* Spill store of one department - min-heap by (key, seq), grown on demand and freed once drained.
+   Every spilled event is no more urgent than the events in the department queue, so refills take the heap top. */
+typedef struct {
+    DeptSpillItem_t *items;
+    UBaseType_t count;
+    UBaseType_t capacity;
+    UBaseType_t highWater;  /* max count seen (metric) */
+    uint32_t    nextSeq;
+    uint32_t    spilled;    /* events that went through the spill store (metric) */
+    uint32_t    failed;     /* events rejected at DEPT_SPILL_CAP (metric) */
+} DeptSpill_t;
+
+/* Load estimator of one department - EWMA of the inter-arrival time and of the service time */
+#define DEPT_LOAD_EWMA_DIV  8   // Weight of a new sample = 1/DEPT_LOAD_EWMA_DIV
+
+typedef struct {
+    TickType_t  lastArrival;            /* tick of the previous arrival (0 = none yet) */
+    uint32_t    arrivalMs;              /* EWMA inter-arrival time in ms (0 = no estimate yet) */
+    uint32_t    serviceMs;              /* EWMA service time (travel + handling) in ms (0 = no estimate yet) */
+    volatile UBaseType_t shedAt;        /* adaptive overload threshold - published by the manager */
+    volatile UBaseType_t onBreak;       /* vehicles on break - published by the manager */
+} DeptLoad_t;
+
+/* Activity of one vehicle - state-time accounting (see FleetStats.h) */
+typedef enum {
+    VEHICLE_IDLE = 0,       // Waiting for work
+    VEHICLE_WAITING,        // Work in sight, blocked on a vehicle token (all taken, or held by the manager for breaks)
+    VEHICLE_BUSY,           // Travelling to or handling an event
+    VEHICLE_RETIRED,        // Outside the active fleet - parked by the autoscaler (not part of the utilization shares)
+    VEHICLE_ACTIVITY_MAX
+} VehicleActivity_t;
 
+/* State-time accounting of one vehicle - changed with FleetStats_SetActivity() only */
+typedef struct {
+    VehicleActivity_t   activity;               /* current activity */
+    TickType_t          since;                  /* tick the current activity started */
+    uint64_t            ms[VEHICLE_ACTIVITY_MAX]; /* time spent per activity (closed intervals) - busy = cumulative service time */
+    uint64_t            gangMs;                 /* extra vehicle-time of multi-vehicle jobs - (units - 1) per busy ms */
+    uint32_t            jobs;                   /* services finished, own and mutual aid */
+} VehicleStats_t;
+
+/* Break accounting of one department - breaks are vehicle tokens held by the manager, not particular vehicles */
+typedef struct {
+    UBaseType_t         onBreak;    /* tokens held for breaks since 'since' */
+    TickType_t          since;
+    uint64_t            ms;         /* vehicle-time on break (closed intervals) */
+} DeptBreakStats_t;
+
+/* State of a vehicle token - every token of a department is in exactly one state */
+typedef enum {
+    DEPT_TOKEN_AVAILABLE = 0,   // In the counting semaphore - a vehicle may take it
+    DEPT_TOKEN_BUSY,            // Held for a job (gang tokens included), or collected for a gang (at the gate, or in the gang hold)
+    DEPT_TOKEN_BREAK,           // Held by the manager for a break
+    DEPT_TOKEN_STATES
+} DeptTokenState_t;
 
-/* --------Queues, Mutexs, countingSemaphores (Dispatcher <-> Departments)-------- */
+/* Vehicle token ledger of one department - changed by the Dept_Reserve / Release / Break / Fleet transitions only,
+   each one assertion-checked: no state goes negative, the states add up to the total, the semaphore never holds
+   more tokens than the ledger counts available */
+typedef struct {
+    UBaseType_t         count[DEPT_TOKEN_STATES]; /* tokens per state */
+    UBaseType_t         total;      /* tokens in existence = active fleet size (the autoscaler adds and removes them) */
+} DeptLedger_t;
+
+/* State of one vehicle - the task parameter of its Task_Vehicle, or a plain record of the service clock (SERVICE_CLOCK=1) */
+typedef struct DepartmentDescription DepartmentDescription_t;
+typedef struct {
+    DepartmentDescription_t *dept;      /* department the vehicle belongs to */
+    UBaseType_t             index;      /* index in dept->fleet */
+    volatile uint8_t        position;   /* current location index (see Location.h) */
+    volatile BaseType_t     idle;       /* pdTRUE while waiting for work */
+    volatile BaseType_t     retire;     /* slot outside the active fleet - park once free (Vehicle_Retire / Vehicle_Activate) */
+    BaseType_t              parked;     /* retired and parked - no work, not on the idle stack */
 
-#define DEPT_Q_LEN  16 // Length of each Department Queue
+    TaskHandle_t            task;       /* vehicle task - set by the task itself */
+    DeptJob_t               mail;       /* handoff mailbox - job delivered by Vehicle_Handoff() */
+    uint32_t                mailKey;    /* ... and its queue key (deadline tick) */
 
-extern QueueHandle_t handle_deptAmbulanceQ;  /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_deptPoliceQ;     /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_deptFireQ;       /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_deptMaintQ;      /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_deptElectQ;      /* use for EmergencyEvent_t */
-extern QueueHandle_t handle_deptWasteQ;      /* use for EmergencyEvent_t */
+    DepartmentDescription_t *servingFor; /* service clock mode - owner of the event in service (mutual aid: another department) */
+    TickType_t              serviceStart; /* ... tick the service started */
+    uint8_t                 scene;      /* ... location the vehicle ends up at */
+    uint32_t                handlingMs; /* ... on-site part of the service */
+    UBaseType_t             clockPos;   /* ... position of the completion in the service clock heap */
 
-extern SemaphoreHandle_t handleMux_deptAmbulanceQ;  // Mutex for Ambulance queue
-extern SemaphoreHandle_t handleMux_deptPoliceQ;     // Mutex for Police queue
-extern SemaphoreHandle_t handleMux_deptFireQ;       // Mutex for Fire Department queue
-extern SemaphoreHandle_t handleMux_deptMaintQ;      // Mutex for Maintenance queue
-extern SemaphoreHandle_t handleMux_deptElectQ;      // Mutex for Electricity queue
-extern SemaphoreHandle_t handleMux_deptWasteQ;      // Mutex for Waste Collection queue
+    UBaseType_t             units;      /* vehicle tokens held for the job in service - its gang size (Dept_Reserve) */
+    volatile uint8_t        jobPriority; /* priority of the job in service, 0 = none - preemption candidate (Vehicle_Preempt) */
+    volatile BaseType_t     preempt;    /* set by Vehicle_Preempt() - give the job back for a critical event */
 
-extern SemaphoreHandle_t handleSem_deptAmbulance;  // Counting Semaphore for Ambulance department
-extern SemaphoreHandle_t handleSem_deptPolice;     // Counting Semaphore for Police department
-extern SemaphoreHandle_t handleSem_deptFire;       // Counting Semaphore for Fire Department
-extern SemaphoreHandle_t handleSem_deptMaint;      // Counting Semaphore for Maintenance department
-extern SemaphoreHandle_t handleSem_deptElect;      // Counting Semaphore for Electricity department
-extern SemaphoreHandle_t handleSem_deptWaste;      // Counting Semaphore for Waste Collection department
+    VehicleStats_t          stats;      /* state-time accounting (FleetStats.h) */
+} VehicleState_t;
 
-/* Helper structure for department description */
- typedef struct
+/* Manager signals - task notification bits sent with Dept_SignalManager() */
+#define DEPT_SIG_BACKLOG    (1u << 0) // Backlog crossed a manager threshold (became non-empty / reached aid or overload level)
+#define DEPT_SIG_VEHICLE    (1u << 1) // A vehicle of the department started or finished service
+
+/* Department description - one registry slot per event type.
+   name/type/vehicles come from the descriptor list, the handles are created on registration. */
+struct DepartmentDescription
 {
     const char *name;
     EventType_t type;
+    volatile UBaseType_t vehicles;  /* active fleet size - fleet[0..vehicles-1], changed by the autoscaler */
+    VehicleState_t *fleet;          /* [maxVehicles] - allocated on registration */
+    VehicleState_t **idleStack;     /* [maxVehicles] - handoff mode: idle vehicles, top = most recently idle */
+    volatile UBaseType_t idleCount; /* vehicles on idleStack */
+    UBaseType_t minVehicles;        /* autoscaling bounds - set on registration (FLEET_MIN_PCT / FLEET_MAX_PCT) */
+    UBaseType_t maxVehicles;
+
+    PQueueHandle_t      queue;          /* use for DeptJob_t - key = deadline tick (Dept_EventKey) */
+    SemaphoreHandle_t   availableSem;   /* counting sem = available vehicles - taken and given through the ledger transitions only */
+    DeptLedger_t        ledger;         /* vehicle token states (Dept_Ledger) */
+    SemaphoreHandle_t   gangMutex;      /* reservation gate - token reservations pass it in FIFO order (Dept_Reserve) */
+    UBaseType_t         gangHeld;       /* handoff modes - tokens collected for a gang head between handoffs (Dept_ReserveHold),
+                                           changed with gangMutex held */
+
+    SemaphoreHandle_t   spillMutex;     /* protects spill, and serializes every send into queue - taken by the routing dispatcher,
+                                           vehicles (Dept_Refill, preempted job requeue), the manager (refill, cancel, TTL sweep)
+                                           and mutual aid helpers, so it is contended whenever a spill is being drained */
+    DeptSpill_t         spill;          /* overflow tier behind queue */
+
+    volatile TaskHandle_t manager;      /* manager task - set by the manager itself, NULL until it runs */
+    volatile SemaphoreHandle_t signalSem; /* supervisor mode - binary sem in the supervisor queue set, NULL otherwise */
+
+    volatile BaseType_t aidWanted;      /* set by the manager while the backlog needs mutual aid (see MutualAid.h) */
+    uint32_t            aidReceived;    /* events served by other departments' vehicles (metric) */
+    uint32_t            aidGiven;       /* events this department's vehicles served for others (metric) */
+
+    DeptLoad_t          load;           /* arrival / service rate estimates (Dept_OnArrival, Dept_OnServiceEnd) */
+    DeptBreakStats_t    breakStats;     /* break time accounting (FleetStats_SetOnBreak) */
+
+    uint32_t            served;         /* events that started service (metric) */
+    uint32_t            deadlineMisses; /* ... of which started after their deadline (metric) */
+    uint32_t            maxLateTicks;   /* worst lateness past the deadline (metric) */
+    uint32_t            expired;        /* events dropped from the backlog past their TTL (metric) */
+};
+
+/* Department registry indexed by EventType_t - a slot is registered once its queue is set */
+extern DepartmentDescription_t g_depts[DEPT_REGISTRY_MAX];
+
+/**
+ * @brief Returns the registered department that handles an event type (one indexed load).
+ * @param type - Event type
+ * @return DepartmentDescription_t* Registry slot, or NULL if the type has no registered department.
+ */
+static inline DepartmentDescription_t *Dept_FromType(EventType_t type)
+{
+    return ((unsigned)type < DEPT_REGISTRY_MAX && g_depts[type].queue != NULL) ? &g_depts[type] : NULL;
+}
+
+/**
+ * @brief Registers a department: creates its priority queue, counting semaphore, spill mutex and fleet state in registry slot 'type'.
+ *        Can be called at startup or at runtime for types beyond EVENT_MAX (the caller then starts its tasks).
+ * @param name - Department name (must stay valid - not copied)
+ * @param type - Event type handled by the department, < DEPT_REGISTRY_MAX
+ * @param vehicles - Initial fleet size (tokens created available, the semaphore max count is the autoscaling maximum)
+ * @return DepartmentDescription_t* Registry slot on success, NULL if the slot is taken/out of range or creation failed.
+ */
+DepartmentDescription_t *Dept_Register(const char *name, EventType_t type, UBaseType_t vehicles);
+
+/**
+ * @brief Department queue key of an arriving event - its deadline tick (now + response-time target of its priority).
+ *        Smaller = more urgent, so backlogs are served earliest-deadline-first.
+ * @param event - Event to key
+ * @return uint32_t Key for xPQueueSend.
+ */
+uint32_t Dept_EventKey(const EmergencyEvent_t *event);
+
+/**
+ * @brief TTL expiry tick of an event entering its department backlog - now + time-to-live of its priority (TTL_xxx_MS).
+ * @param event - Arriving event
+ * @return uint32_t Value for DeptJob_t.expiresAt, 0 if the event never expires (or EVENT_TTL_ENABLE=0).
+ */
+uint32_t Dept_EventExpiry(const EmergencyEvent_t *event);
+
+/**
+ * @brief Returns pdTRUE if a waiting job is past its TTL. A preempted job (remainingMs != 0) already started and never expires.
+ * @param job - Job in a department backlog
+ * @param now - Current tick count
+ */
+static inline BaseType_t Dept_EventExpired(const DeptJob_t *job, TickType_t now)
+{
+    return (job->expiresAt != 0 && job->remainingMs == 0 &&
+            (int32_t)((uint32_t)now - job->expiresAt) >= 0) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief Vehicles an event needs at once - its catalog units, clamped to 1..fleet size.
+ * @param d - Department that serves the event
+ * @param event - Event
+ * @return UBaseType_t Gang size to reserve with Dept_Reserve().
+ */
+UBaseType_t Dept_EventUnits(const DepartmentDescription_t *d, const EmergencyEvent_t *event);
+
+/**
+ * @brief Gang allocation - takes 'units' vehicle tokens of the department, all or nothing.
+ *        Reservations pass the department gate (gangMutex) one at a time in FIFO order, and only the reservation
+ *        holding the gate ever holds part of its tokens. A large reservation at the gate collects tokens as vehicles
+ *        free up while later ones, small ones included, queue behind it - it is never starved. Tokens are given back
+ *        without the gate, so a partial reservation never blocks the vehicles it waits for (no hold-and-wait cycle).
+ *        The guarantee needs a caller that waits - callers that must not block use Dept_ReserveHold().
+ * @param d - Department
+ * @param units - Tokens to take (1..fleet size)
+ * @param xTicksToWait - Max time to wait for the gate and the tokens (0 = only if the gate is free and all tokens are)
+ * @return BaseType_t pdPASS if all tokens were taken, pdFAIL on timeout (none are held then).
+ */
+BaseType_t Dept_Reserve(DepartmentDescription_t *d, UBaseType_t units, TickType_t xTicksToWait);
+
+/**
+ * @brief Gang allocation without waiting (handoff modes) - collects free tokens for the head event into the department
+ *        gang hold (gangHeld) across calls, and hands them over once the hold covers 'units'. Every token that frees up
+ *        while a gang head waits goes into the hold, so single-vehicle takers cannot starve it.
+ *        A smaller head takes its tokens from the hold and gives back the rest.
+ * @attention Handoff modes only - takes the gate with portMAX_DELAY, which no caller there keeps while it blocks.
+ * @param d - Department
+ * @param units - Tokens the head event needs (1..fleet size), 0 = no head any more - give the hold back
+ * @return BaseType_t pdPASS if 'units' tokens were taken (the hold is empty again), pdFAIL while the hold is short.
+ */
+BaseType_t Dept_ReserveHold(DepartmentDescription_t *d, UBaseType_t units);
+
+/**
+ * @brief Gives back vehicle tokens taken with Dept_Reserve().
+ * @param d - Department
+ * @param units - Tokens to give back (0 = nothing)
+ */
+void Dept_Release(DepartmentDescription_t *d, UBaseType_t units);
+
+/**
+ * @brief Break policy - takes one free vehicle token for a break, through the reservation gate without waiting.
+ * @param d - Department
+ * @return BaseType_t pdPASS if a token went on break, pdFAIL if none is free (or a reservation holds the gate).
+ */
+BaseType_t Dept_BreakStart(DepartmentDescription_t *d);
+
+/**
+ * @brief Break policy - returns vehicle tokens from break.
+ * @param d - Department
+ * @param units - Tokens to return (0 = nothing)
+ */
+void Dept_BreakEnd(DepartmentDescription_t *d, UBaseType_t units);
+
+/**
+ * @brief Autoscaling - creates one vehicle token (available) for a vehicle added to the active fleet.
+ * @param d - Department
+ */
+void Dept_FleetGrow(DepartmentDescription_t *d);
+
+/**
+ * @brief Autoscaling - destroys one vehicle token for a vehicle leaving the active fleet.
+ * @param d - Department
+ * @param fromBreak - pdTRUE to destroy a token on break, pdFALSE to take a free one through the reservation gate
+ * @return BaseType_t pdPASS if a token was destroyed, pdFAIL if no free token could be taken.
+ */
+BaseType_t Dept_FleetShrink(DepartmentDescription_t *d, BaseType_t fromBreak);
 
-    QueueHandle_t       queue;
-    SemaphoreHandle_t   mutex;     /* protects dept queue */
-    SemaphoreHandle_t   availableSem;   /* counting sem = available vehicles */
-} DepartmentDescription_t;
+/**
+ * @brief Snapshot of the vehicle token ledger and the effective capacity of the department.
+ * @param d - Department
+ * @param out - Output snapshot
+ * @return UBaseType_t Effective capacity - tokens in the semaphore plus tokens held (busy, on break). Equals the active
+ *         fleet size while no token is lost or duplicated, lower only for an instant while a take is being recorded.
+ */
+UBaseType_t Dept_Ledger(const DepartmentDescription_t *d, DeptLedger_t *out);
+
+/**
+ * @brief Records that a vehicle started handling an event, and counts a deadline miss if it started late.
+ *        A resumed preempted job (remainingMs != 0) was counted when it first started and is skipped.
+ * @param d - Department that owns the event
+ * @param job - Job taken from the backlog
+ * @param deadline - Key the job was queued with (deadline tick)
+ */
+void Dept_OnServiceStart(DepartmentDescription_t *d, const DeptJob_t *job, uint32_t deadline);
+
+/**
+ * @brief Records an arrival in the department load estimator (EWMA of the inter-arrival time).
+ * @attention Called by the task that routes the events of the department.
+ * @param d - Department
+ */
+void Dept_OnArrival(DepartmentDescription_t *d);
+
+/**
+ * @brief Records a finished service in the department load estimator (EWMA of the service time).
+ * @attention Report services of own events that ran in one piece only - a preempted or resumed job is not a sample.
+ * @param d - Department
+ * @param serviceMs - Time the vehicle spent on the event (travel + handling)
+ */
+void Dept_OnServiceEnd(DepartmentDescription_t *d, uint32_t serviceMs);
+
+/**
+ * @brief Current load estimates of a department.
+ *        The inter-arrival estimate decays while no event arrives: the time since the last arrival is used
+ *        once it is longer than the EWMA, so a department that went quiet does not look busy forever.
+ * @param d - Department
+ * @param arrivalMs - Output: inter-arrival time in ms (0 = no estimate yet)
+ * @param serviceMs - Output: service time in ms (0 = no estimate yet)
+ */
+void Dept_LoadEstimate(const DepartmentDescription_t *d, uint32_t *arrivalMs, uint32_t *serviceMs);
+
+/**
+ * @brief Adds an event to the department backlog: the queue if it has space, else the spill store.
+ *        On a full queue a more urgent event takes the place of the least urgent queued one, which is spilled.
+ * @param d - Department
+ * @param event - Event to add
+ * @param helpers - Departments that may serve it by mutual aid (DeptJob_t.helpers, see MutualAid_Helpers), 0 = none
+ * @param rejected - Output: the event that was dropped when the spill store is at DEPT_SPILL_CAP
+ * @return BaseType_t pdPASS if the event was stored, pdFAIL if 'rejected' was dropped (send a STATUS_FAILED completion).
+ */
+BaseType_t Dept_Enqueue(DepartmentDescription_t *d, const EmergencyEvent_t *event, uint32_t helpers, EmergencyEvent_t *rejected);
+
+/**
+ * @brief Puts a job back into the department backlog with a given key (spill / fail policy of Dept_Enqueue()).
+ *        Used for preempted jobs, which keep their original deadline and their remaining handling time.
+ * @param d - Department
+ * @param job - Job to add
+ * @param key - Queue key (deadline tick) of the job
+ * @param rejected - Output: the event that was dropped when the spill store is at DEPT_SPILL_CAP
+ * @return BaseType_t pdPASS if the job was stored, pdFAIL if 'rejected' was dropped (send a STATUS_FAILED completion).
+ */
+BaseType_t Dept_Requeue(DepartmentDescription_t *d, const DeptJob_t *job, uint32_t key, EmergencyEvent_t *rejected);
+
+/**
+ * @brief Moves spilled events back into the department queue while it has space.
+ * @attention Call after removing events from the queue (vehicles, manager).
+ * @param d - Department
+ */
+void Dept_Refill(DepartmentDescription_t *d);
+
+/**
+ * @brief Removes the least urgent event of the whole backlog (spill store first, then the queue).
+ * @param d - Department
+ * @param event - Output event
+ * @return BaseType_t pdPASS on success, pdFAIL if the backlog is empty.
+ */
+BaseType_t Dept_RemoveLowest(DepartmentDescription_t *d, EmergencyEvent_t *event);
+
+/**
+ * @brief Removes one event that is past its TTL from the backlog (spill store first, then the queue) and counts it.
+ *        O(backlog) scan - called by the manager sweep; vehicles check the event they dequeue instead.
+ * @param d - Department
+ * @param event - Output expired event (send a STATUS_EXPIRED completion)
+ * @return BaseType_t pdPASS if an event was removed, pdFAIL if nothing in the backlog expired.
+ */
+BaseType_t Dept_TakeExpired(DepartmentDescription_t *d, EmergencyEvent_t *event);
+
+/**
+ * @brief Removes the most urgent job of the backlog that a predicate accepts - the queue first, then the spill store
+ *        (spilled jobs are never more urgent than queued ones). Never blocks on the queue.
+ * @param d - Department
+ * @param xPredicate - Filter, called with a const DeptJob_t* - inside a critical section for queued jobs, keep it O(1)
+ * @param pvContext - Passed to the predicate
+ * @param job - Output job
+ * @param key - Output queue key (deadline tick), may be NULL
+ * @return BaseType_t pdPASS if a job was taken, pdFAIL if the predicate accepts none.
+ */
+BaseType_t Dept_TakeIf(DepartmentDescription_t *d, PQueuePredicate_t xPredicate, void *pvContext, DeptJob_t *job, uint32_t *key);
+
+/**
+ * @brief Number of events waiting in the department queue and spill store.
+ * @param d - Department
+ * @return UBaseType_t Backlog length.
+ */
+UBaseType_t Dept_Backlog(const DepartmentDescription_t *d);
+
+/**
+ * @brief Wakes the department manager (task notification, bits are OR-ed so signals coalesce while it runs),
+ *        or in supervisor mode gives the department signal semaphore (signals coalesce the same way).
+ * @param d - Department
+ * @param bits - DEPT_SIG_xxx
+ */
+void Dept_SignalManager(DepartmentDescription_t *d, uint32_t bits);
 
-/* Create UDP & Client department queues, mutexes and counting semaphores */
-BaseType_t CreateClientDepartmentQueuesSemaphoresAndMutex(void);
+/* Create UDP queues, and register every department of the descriptor list (queues and counting semaphores) */
+BaseType_t CreateClientDepartmentQueuesSemaphoresAndMutex(const DepartmentDescription_t *list, size_t count);
 BaseType_t CreateUDPQueues(void);
 
 
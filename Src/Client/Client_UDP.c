@@ -6,8 +6,10 @@
 
 #include "Shared_Configuration.h"
 #include "Client/Client_UDP.h"
+#include "Client/DispatcherAndMangerDepartment_Task.h" // Fast path routing
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
@@ -17,9 +19,26 @@
 static int ClientSock = -1; // Defining general Client UDP socket variable
 static struct sockaddr_in serverAddr; // Defining general Server address structure
 
+/* Completion journal - many producers (vehicles, managers) append, vClientUDPTxTask is the only consumer */
+static CompletionMsg_t journal[COMPLETION_JOURNAL_LEN];
+static volatile uint32_t journalHead = 0; // Next slot to write (producers, under critical section)
+static volatile uint32_t journalTail = 0; // Next slot to send (TX task only)
+static CompletionJournalStats_t journalStats;
+
+/* Overflow tier behind a full journal ring - heap nodes in append order, sent before the ring */
+typedef struct JournalOverflowNode {
+    struct JournalOverflowNode *next;
+    CompletionMsg_t msg;
+} JournalOverflowNode_t;
+
+static JournalOverflowNode_t *overflowHead = NULL; // Oldest node - consumed by the TX task only
+static JournalOverflowNode_t *overflowTail = NULL; // Newest node - producers link behind it (under critical section)
+static uint32_t overflowCount = 0;
+static TaskHandle_t txTaskHandle = NULL; // Notified when the journal gets new completions
+
 
 /* Initialize the UDP client socket */
-int ClientUDP_Init(void)
+int ClientUDP_Init(uint16_t port)
 {
     struct sockaddr_in clientAddr; // Client address structure
 
@@ -32,7 +51,7 @@ int ClientUDP_Init(void)
 
     memset(&clientAddr, 0, sizeof(clientAddr));
     clientAddr.sin_family = AF_INET;
-    clientAddr.sin_port   = htons(UDP_CLIENT_PORT); 
+    clientAddr.sin_port   = htons(port); 
     clientAddr.sin_addr.s_addr = INADDR_ANY;
 
     /* Bind the socket to the client address */
@@ -48,7 +67,7 @@ int ClientUDP_Init(void)
     serverAddr.sin_port   = htons(UDP_SERVER_PORT);
     inet_pton(AF_INET, UDP_IP_Addr, &serverAddr.sin_addr);
 
-    printf("[Client][UDP] Listening on port %d\n", UDP_CLIENT_PORT);
+    printf("[Client][UDP] Listening on port %u\n", (unsigned)port);
     return 0;
 }
 
@@ -58,6 +77,19 @@ int ClientUDP_GetSocket(void)
     return ClientSock; // Return the client socket descriptor
 }
 
+/**
+ * @brief Echoes one event back as a successful completion (transport benchmark client).
+ * @param event - Event received from the server
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void ClientEchoEvent(const EmergencyEvent_t *event)
+{
+    /* Same event ID as received, marked as handled by ECHO - echo never fails */
+    ClientUDP_JournalCompletion(event->eventID, "ECHO", STATUS_SUCCESS);
+    TRANSPORT_LOG("[Client][ECHO] Processed event id=%u\n", (unsigned)event->eventID);
+}
+
 /* Receive UDP packets and send to RX queue */
 void vClientUDPRxTask(void *pvParameters)
 {
@@ -73,16 +105,40 @@ void vClientUDPRxTask(void *pvParameters)
 
     /* Main loop to receive UDP packets from Server */
     for (;;) {
-        EmergencyEvent_t event;
-        ssize_t n = recvfrom(ClientSock, &event, sizeof(event), 0, NULL, NULL);
+        union { // Datagrams are told apart by size (and magic for heartbeats)
+            EmergencyEvent_t event;
+            HeartbeatMsg_t   hb;
+        } rx;
+        ssize_t n = recvfrom(ClientSock, &rx, sizeof(rx), 0, NULL, NULL);
+
+        /* Heartbeat request - stamp and reply immediately so the Server can estimate RTT and offset */
+        if (n == (ssize_t)sizeof(rx.hb) && rx.hb.magic == HEARTBEAT_MAGIC) {
+            rx.hb.t2 = (uint32_t)xTaskGetTickCount(); // Receive tick
+            rx.hb.t3 = (uint32_t)xTaskGetTickCount(); // Transmit tick - taken just before sendto
+            (void)sendto(ClientSock, &rx.hb, sizeof(rx.hb), 0,
+                         (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+            continue; // Continue to next iteration
+        }
 
         /* Check if the received data matches the expected size */
-        if (n == (ssize_t)sizeof(event)) {
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPRxQ, &event, 0);
+        if (n == (ssize_t)sizeof(rx.event)) {
+            EmergencyEvent_t event = rx.event;
+
+            /* Fast path - no RX lanes / dispatcher hop: classify and enqueue into the department right here */
+#if FAST_PATH && TRANSPORT_BENCH
+            ClientEchoEvent(&event); // The journal append never blocks the RX task
+            continue; // Continue to next iteration
+#elif FAST_PATH
+            Dispatcher_Route(&event);
+            continue; // Continue to next iteration
+#endif
+
+            const UBaseType_t shard = DispatcherShardOf(event.type); // RX lanes of the dispatcher owning the department
+            BaseType_t queueCheck = QosLanes_Send(&lanes_clientUDPRx[shard], &event, 0);
             if (queueCheck != pdPASS) {
-                printf("[Client][UDP-RX] DROP id=%u (RX queue full)\n", (unsigned)event.eventID);
+                printf("[Client][UDP-RX] DROP id=%u (RX lane of shard %u full)\n", (unsigned)event.eventID, (unsigned)shard);
             } else {
-                printf("[Client][UDP-RX] Sent to queue id=%u type=%d\n",
+                TRANSPORT_LOG("[Client][UDP-RX] Sent to queue id=%u type=%d\n",
                        (unsigned)event.eventID, (int)event.type);
             }
             continue; // Continue to next iteration
@@ -113,7 +169,68 @@ void vClientUDPRxTask(void *pvParameters)
     vTaskDelete(NULL); // Delete and free resources - Should never reach here
 }
 
-/* Send UDP packets from TX queue to Server */
+/* Append completion to the journal - the ring if it has a free slot, else the overflow tier */
+void ClientUDP_PostCompletion(const CompletionMsg_t *msg)
+{
+    BaseType_t appended = pdFALSE;
+
+    taskENTER_CRITICAL();
+    uint32_t used = journalHead - journalTail;
+    if (used < COMPLETION_JOURNAL_LEN) {
+        journal[journalHead % COMPLETION_JOURNAL_LEN] = *msg;
+        journalHead++;
+        journalStats.appended++;
+        if (used + 1 > journalStats.highWater) journalStats.highWater = used + 1;
+        appended = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    if (appended != pdTRUE) {
+        /* Ring full - allocate outside the critical section, then link the node behind the newest one */
+        JournalOverflowNode_t *node = pvPortMalloc(sizeof(*node));
+        configASSERT(node != NULL); // Heap exhausted - fatal, a completion is never given up
+        node->next = NULL;
+        node->msg  = *msg;
+
+        taskENTER_CRITICAL();
+        if (overflowTail != NULL) overflowTail->next = node;
+        else                      overflowHead = node;
+        overflowTail = node;
+        overflowCount++;
+        journalStats.appended++;
+        journalStats.overflows++;
+        if (overflowCount > journalStats.overflowHighWater) journalStats.overflowHighWater = overflowCount;
+        taskEXIT_CRITICAL();
+    }
+
+    if (txTaskHandle != NULL) {
+        xTaskNotifyGive(txTaskHandle); // Wake the TX task
+    }
+}
+
+/* Build a completion (end timestamp = now) and append it to the journal */
+void ClientUDP_JournalCompletion(uint32_t eventID, const char *handledBy, uint8_t status)
+{
+    CompletionMsg_t msg;
+    memset(&msg, 0, sizeof(msg));
+
+    msg.eventID = eventID;
+    msg.status  = status;
+    snprintf(msg.handledBy, sizeof(msg.handledBy), "%s", handledBy); // "%s" - names are not format strings
+    msg.timestampEnd = (uint32_t)xTaskGetTickCount(); // Current tick count as end timestamp
+
+    ClientUDP_PostCompletion(&msg);
+}
+
+/* Copy journal counters */
+void ClientUDP_GetJournalStats(CompletionJournalStats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = journalStats;
+    taskEXIT_CRITICAL();
+}
+
+/* Send batches of completions from the journal to Server */
 void vClientUDPTxTask(void *pvParameters)
 {
     (void)pvParameters;
@@ -124,29 +241,84 @@ void vClientUDPTxTask(void *pvParameters)
         vTaskDelete(NULL);
     }
 
+    txTaskHandle = xTaskGetCurrentTaskHandle();
+
     printf("[Client][UDP-TX] Started\n");
 
-    /* Main loop to send UDP packets to Server */
+    /* Main loop to send UDP batches to Server */
     for (;;) {
-        CompletionMsg_t msg; // Completion message to send
+        /* Sleep until something was appended (timeout re-checks in case a send failed) */
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(Long_Delay_MS));
+
+        for (;;) {
+            CompletionBatch_t batch;
+            batch.magic = COMPLETION_BATCH_MAGIC;
+            batch.count = 0;
+
+            /* Copy (do not consume yet) up to one batch - the overflow tier first (older), then the journal tail */
+            uint32_t fromOverflow = 0;
+            taskENTER_CRITICAL();
+            for (const JournalOverflowNode_t *node = overflowHead;
+                 node != NULL && batch.count < COMPLETION_BATCH_MAX; node = node->next) {
+                batch.items[batch.count++] = node->msg;
+            }
+            fromOverflow = batch.count;
+            uint32_t used = journalHead - journalTail;
+            while (batch.count - fromOverflow < used && batch.count < COMPLETION_BATCH_MAX) {
+                batch.items[batch.count] = journal[(journalTail + batch.count - fromOverflow) % COMPLETION_JOURNAL_LEN];
+                batch.count++;
+            }
+            taskEXIT_CRITICAL();
 
-        /* Receive completion message from TX queue */
-        if (xQueueReceive(handle_clientUDPTxQ, &msg, portMAX_DELAY) == pdPASS) {
-            (void)sendto(ClientSock, &msg, sizeof(msg), 0,
-                         (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+            if (batch.count == 0) break; // Journal drained
 
-            printf("[Client][UDP-TX] Sent completion for event id=%u\n",
-                   (unsigned)msg.eventID);
+            size_t len = offsetof(CompletionBatch_t, items) + batch.count * sizeof(CompletionMsg_t);
+            ssize_t s = sendto(ClientSock, &batch, len, 0,
+                               (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+            if (s != (ssize_t)len) {
+                /* Keep the batch in the journal and retry later - completions are never dropped here */
+                printf("[Client][UDP-TX] sendto failed: %s (batch n=%u kept)\n",
+                       strerror(errno), (unsigned)batch.count);
+                vTaskDelay(pdMS_TO_TICKS(Short_Delay_MS));
+                continue;
+            }
+
+            /* Sent - consume the batch (unlink the sent overflow nodes, free them outside the critical section) */
+            JournalOverflowNode_t *sent = NULL;
+            taskENTER_CRITICAL();
+            if (fromOverflow > 0) {
+                JournalOverflowNode_t *last = overflowHead;
+                for (uint32_t i = 1; i < fromOverflow; i++) last = last->next;
+                sent = overflowHead;
+                overflowHead = last->next;
+                if (overflowHead == NULL) overflowTail = NULL;
+                last->next = NULL;
+                overflowCount -= fromOverflow;
+            }
+            journalTail += batch.count - fromOverflow;
+            journalStats.sent += batch.count;
+            journalStats.batches++;
+            if (batch.count > journalStats.maxBatch) journalStats.maxBatch = batch.count;
+            taskEXIT_CRITICAL();
+
+            while (sent != NULL) {
+                JournalOverflowNode_t *next = sent->next;
+                vPortFree(sent);
+                sent = next;
+            }
+
+            TRANSPORT_LOG("[Client][UDP-TX] Sent batch n=%u first id=%u\n",
+                   (unsigned)batch.count, (unsigned)batch.items[0].eventID);
         }
     }
 
     vTaskDelete(NULL); // Delete and free resources - Should never reach here
 }
 
-/* Echo task used for testing UDP Transmission */
+/* Echo task used for testing UDP Transmission - one per dispatcher shard */
 void vClientEchoTask(void *pvParameters)
 {
-    (void)pvParameters;
+    QosLanes_t *lanes = &lanes_clientUDPRx[(UBaseType_t)(uintptr_t)pvParameters]; // Shard index
 
     printf("[Client][ECHO] Started\n");
 
@@ -154,22 +326,10 @@ void vClientEchoTask(void *pvParameters)
     for (;;) {
         EmergencyEvent_t event;
 
-        /* Receive an emergency event from the RX queue */
-        if (xQueueReceive(handle_clientUDPRxQ, &event, portMAX_DELAY) == pdPASS) {
-            CompletionMsg_t ComMSG; // Completion message to send back
-            memset(&ComMSG, 0, sizeof(ComMSG));
-
-            /* Initialize the completion message */
-            ComMSG.eventID = event.eventID; // Same event ID as received
-            snprintf(ComMSG.handledBy, sizeof(ComMSG.handledBy), "ECHO"); // Mark as handled by ECHO
-            ComMSG.timestampEnd = (uint32_t)xTaskGetTickCount(); // Current tick count as end timestamp
-            ComMSG.status = (rand() % 1000 < 50) ? 1 : 0; // Creating 50% success using random number
-
-
-            (void)xQueueSend(handle_clientUDPTxQ, &ComMSG, 0); // Send to TX queue
+        /* Receive an emergency event from the RX lanes */
+        if (QosLanes_Receive(lanes, &event, portMAX_DELAY) == pdPASS) {
+            ClientEchoEvent(&event);
         }
-
-        printf("[Client][ECHO] Processed event id=%u\n", (unsigned)event.eventID);
     }
 
     vTaskDelete(NULL); // Delete and free resources - Should never reach here
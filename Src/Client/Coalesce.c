@@ -0,0 +1,143 @@
+/**
+ * @file Coalesce.c
+ * @brief Implementation of incident de-duplication (time-bucketed hash index of live incidents).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#include "Client/Coalesce.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/* One live incident of the index */
+typedef struct {
+    uint32_t    hash;                       // Key hash, 0 = slot never used
+    uint32_t    liveID;                     // Event that opened the incident, 0 = closed (slot reusable)
+    uint32_t    bucket;                     // Time bucket of the first report
+    uint32_t    lastReporterID;             // Latest duplicate merged into it
+    uint16_t    reporters;                  // Reports merged so far, the first one included
+    EventType_t type;                       // Key
+    char        location[sizeof(((EmergencyEvent_t *)0)->location)];
+    char        detail[sizeof(((EmergencyEvent_t *)0)->event_detail)];
+} CoalesceEntry_t;
+
+static CoalesceEntry_t incidents[COALESCE_SLOTS]; // Shared by all dispatcher shards - changed inside critical sections
+
+
+/**
+ * @brief FNV-1a hash of the incident key (type, location, detail) - never 0.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t KeyHash(const EmergencyEvent_t *event)
+{
+    uint32_t h = 2166136261u ^ (uint32_t)event->type;
+    h *= 16777619u;
+    for (size_t i = 0; i < sizeof(event->location) && event->location[i] != '\0'; i++) {
+        h = (h ^ (uint8_t)event->location[i]) * 16777619u;
+    }
+    h = (h ^ 0xFFu) * 16777619u; // Separator - "ab"+"c" differs from "a"+"bc"
+    for (size_t i = 0; i < sizeof(event->event_detail) && event->event_detail[i] != '\0'; i++) {
+        h = (h ^ (uint8_t)event->event_detail[i]) * 16777619u;
+    }
+    return h ? h : 1u;
+}
+
+/**
+ * @brief Current time bucket of the coalescing window.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t NowBucket(void)
+{
+    return (uint32_t)(xTaskGetTickCount() / pdMS_TO_TICKS(COALESCE_BUCKET_MS));
+}
+
+/**
+ * @brief pdTRUE if the entry holds an open incident whose first report is still inside the window.
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t IsLive(const CoalesceEntry_t *e, uint32_t bucket)
+{
+    return (e->liveID != 0 && (bucket - e->bucket) < (COALESCE_WINDOW_MS / COALESCE_BUCKET_MS)) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief pdTRUE if the entry is keyed by the event's (type, location, detail).
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t KeyEquals(const CoalesceEntry_t *e, uint32_t hash, const EmergencyEvent_t *event)
+{
+    return (e->hash == hash && e->type == event->type &&
+            strncmp(e->location, event->location, sizeof(e->location)) == 0 &&
+            strncmp(e->detail, event->event_detail, sizeof(e->detail)) == 0) ? pdTRUE : pdFALSE;
+}
+
+uint32_t Coalesce_Admit(const EmergencyEvent_t *event, uint16_t *reporters)
+{
+    const uint32_t hash = KeyHash(event);
+    const uint32_t bucket = NowBucket();
+    CoalesceEntry_t *slot = NULL;
+    uint32_t liveID = 0;
+    uint16_t count = 1;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < COALESCE_PROBE_MAX; i++) {
+        CoalesceEntry_t *e = &incidents[(hash + i) & (COALESCE_SLOTS - 1)];
+
+        if (IsLive(e, bucket)) {
+            if (KeyEquals(e, hash, event)) { // Same incident - merge
+                e->reporters++;
+                e->lastReporterID = event->eventID;
+                liveID = e->liveID;
+                count = e->reporters;
+                break;
+            }
+            continue; // Another live incident - keep probing
+        }
+
+        if (slot == NULL) slot = e; // Closed or aged out - reusable
+        if (e->hash == 0) break;    // Never used - the key is not further along
+    }
+
+    if (liveID == 0 && slot != NULL) { // Open a new incident (a full probe window only leaves it unindexed)
+        slot->hash           = hash;
+        slot->liveID         = event->eventID;
+        slot->bucket         = bucket;
+        slot->lastReporterID = 0;
+        slot->reporters      = 1;
+        slot->type           = event->type;
+        memcpy(slot->location, event->location, sizeof(slot->location));
+        memcpy(slot->detail, event->event_detail, sizeof(slot->detail));
+    }
+    taskEXIT_CRITICAL();
+
+    if (reporters != NULL) *reporters = count;
+    return liveID;
+}
+
+void Coalesce_Close(const EmergencyEvent_t *event)
+{
+    const uint32_t hash = KeyHash(event);
+    uint16_t reporters = 0;
+    uint32_t lastReporterID = 0;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < COALESCE_PROBE_MAX; i++) {
+        CoalesceEntry_t *e = &incidents[(hash + i) & (COALESCE_SLOTS - 1)];
+
+        if (e->hash == 0) break;
+        if (e->liveID == event->eventID && KeyEquals(e, hash, event)) {
+            reporters = e->reporters;
+            lastReporterID = e->lastReporterID;
+            e->liveID = 0; // Slot stays in the probe chain (hash kept), reusable
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (reporters > 1) {
+        printf("[Client][%s] Incident id=%u closed (reporters=%u, last duplicate id=%u)\n",
+               pcTaskGetName(NULL), (unsigned)event->eventID, (unsigned)reporters, (unsigned)lastReporterID);
+    }
+}
@@ -2,271 +2,565 @@
  * @file Dispatcher_Task.c
  * @brief Receives events from UDP RX queue and forwards them to the appropriate department queue based on event type.
  * 
- * @attention Static functions are used to map event types to their respective queues, semaphores and mutexes and only used within this file.
+ * @attention Departments are looked up in the registry (g_depts) by event type - see Dept_FromType().
  */
 
 #include "Client/DispatcherAndMangerDepartment_Task.h"
+#include "Client/Client_UDP.h"
+#include "Client/MutualAid.h"
+#include "Client/Vehicle_Task.h"
+#include "Client/FleetStats.h"
+#include "Client/Coalesce.h"
 #include "Shared_Configuration.h"
 
 #include <stdio.h>
+#include <string.h>
+
+
+DispatcherStats_t g_dispatcherStats[DISPATCHER_SHARDS]; // Throughput counters, indexed by shard
 
 
 /**
- * @brief Maps EventType_t to corresponding department queue handle using switch case function.
- *        Been Called only within this file and used in Dispatcher task to forward events.
- * @param type Given event type of EventType_t enum.
+ * @brief Reports an event that will not be handled to the server (cancelled / failed / coalesced / expired).
+ * @param event - Event that is dropped
+ * @param status - STATUS_CANCELLED, STATUS_FAILED, STATUS_COALESCED or STATUS_EXPIRED
  * 
- * @attention This function is static and only used within this file.
- * @return QueueHandle_t Corresponding department queue handle, or NULL if invalid type.
+ * @attention Runs in dispatchers, managers and the UDP RX fast path - the journal append never blocks.
+ *            This function is static and only used within this file.
  */
-static QueueHandle_t DeptQueueFromType(EventType_t type)
+static void PostDroppedCompletion(const EmergencyEvent_t *event, uint8_t status)
 {
-    switch (type) {
-        case EVENT_AMBULANCE:           return handle_deptAmbulanceQ;
-        case EVENT_POLICE:              return handle_deptPoliceQ;
-        case EVENT_FIRE_DEPARTMENT:     return handle_deptFireQ;
-        case EVENT_MAINTENANCE:         return handle_deptMaintQ;
-        case EVENT_WASTE_COLLECTION:    return handle_deptWasteQ;
-        case EVENT_ELECTRICITY:         return handle_deptElectQ;
-        default:                        return NULL; // Invalid type
-    }
+#if COALESCE_ENABLE
+    Coalesce_Close(event); // No-op for a duplicate - its live incident stays open
+#endif
+
+    ClientUDP_JournalCompletion(event->eventID, pcTaskGetName(NULL), status);
 }
 
-/**
- * @brief Maps EventType_t to corresponding department mutex handle using switch case function.
- *        Been Called only within this file and used in Dispatcher task to protect department queues.
- * @param type Given event type of EventType_t enum.
- * 
- * @attention This function is static and only used within this file.
- * @return SemaphoreHandle_t Corresponding department mutex handle, or NULL if invalid type.
- */
-static SemaphoreHandle_t DeptMutexFromType(EventType_t type)
+/* ---------- INIT ---------- */
+
+void ClientDeptManager_Init(void)
 {
-    switch (type) {
-        case EVENT_AMBULANCE:        return handleMux_deptAmbulanceQ;
-        case EVENT_POLICE:           return handleMux_deptPoliceQ;
-        case EVENT_FIRE_DEPARTMENT:  return handleMux_deptFireQ;
-        case EVENT_MAINTENANCE:      return handleMux_deptMaintQ;
-        case EVENT_WASTE_COLLECTION: return handleMux_deptWasteQ;
-        case EVENT_ELECTRICITY:      return handleMux_deptElectQ;
-        default:                     return NULL; // Invalid type
+    /* Tokens are created with the fleet (Dept_Register) - check them instead of seeding more */
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d == NULL) continue;
+
+        DeptLedger_t ledger;
+        const UBaseType_t capacity = Dept_Ledger(d, &ledger);
+        configASSERT(capacity == d->vehicles && ledger.count[DEPT_TOKEN_AVAILABLE] == d->vehicles);
+        (void)capacity;
     }
+
+    printf("[Client][ALL MANAGERS] Department registry initialized and vehicle tokens checked\n");
 }
 
+
+
+/* ---------- TASKS ---------- */
+
 /**
- * @brief Maps EventType_t to corresponding department counting semaphore handle using switch case function.
- *        Been Called only within this file and can be used in Dispatcher or Vehicle tasks to manage vehicle availability.
- * @param type Given event type of EventType_t enum.
+ * @brief Prints the throughput of one dispatcher shard over the last report window.
+ * @param shard - Shard index
+ * @param last - Counters at the start of the window, updated to the current counters
+ * @param ms - Length of the window
  * 
  * @attention This function is static and only used within this file.
- * @return SemaphoreHandle_t Corresponding department counting semaphore handle, or NULL if invalid type.
  */
-static SemaphoreHandle_t DeptVehicleSemFromType(EventType_t type)
+static void DispatcherReport(UBaseType_t shard, DispatcherStats_t *last, uint32_t ms)
 {
-    switch (type) {
-        case EVENT_AMBULANCE:        return handleSem_deptAmbulance;
-        case EVENT_POLICE:           return handleSem_deptPolice;
-        case EVENT_FIRE_DEPARTMENT:  return handleSem_deptFire;
-        case EVENT_MAINTENANCE:      return handleSem_deptMaint;
-        case EVENT_WASTE_COLLECTION: return handleSem_deptWaste;
-        case EVENT_ELECTRICITY:      return handleSem_deptElect;
-        default:                     return NULL;
+    const DispatcherStats_t *s = &g_dispatcherStats[shard];
+    const uint32_t routed = s->routed - last->routed;
+
+    if (routed != 0 || s->failed != last->failed || s->coalesced != last->coalesced || s->invalid != last->invalid) { // Quiet while idle
+        printf("[Client][%s] routed=%u (%u.%02u/s) spilled=%u failed=%u coalesced=%u invalid=%u rx-backlog=%u (total routed=%u)\n",
+               pcTaskGetName(NULL), (unsigned)routed,
+               (unsigned)(routed * 1000u / ms), (unsigned)(routed * 100000u / ms % 100u),
+               (unsigned)(s->spilled - last->spilled), (unsigned)(s->failed - last->failed),
+               (unsigned)(s->coalesced - last->coalesced), (unsigned)(s->invalid - last->invalid),
+               (unsigned)QosLanes_MessagesWaiting(&lanes_clientUDPRx[shard]), (unsigned)s->routed);
     }
-}
 
+    last->routed  = s->routed;
+    last->spilled = s->spilled;
+    last->failed  = s->failed;
+    last->coalesced = s->coalesced;
+    last->invalid = s->invalid;
+}
 
-static SemaphoreHandle_t DeptAvailSemFromType(EventType_t type)
+/* Route one event into its department backlog - dispatcher tasks, or the UDP-RX task directly in fast path mode */
+void Dispatcher_Route(const EmergencyEvent_t *event)
 {
-    switch (type) {
-        case EVENT_AMBULANCE:           return handleSem_deptAmbulance;
-        case EVENT_POLICE:              return handleSem_deptPolice;
-        case EVENT_FIRE_DEPARTMENT:     return handleSem_deptFire;
-        case EVENT_MAINTENANCE:         return handleSem_deptMaint;
-        case EVENT_WASTE_COLLECTION:    return handleSem_deptWaste;
-        case EVENT_ELECTRICITY:         return handleSem_deptElect;
-        default:                        return NULL;
-    }
-}
+    DispatcherStats_t *stats = &g_dispatcherStats[DispatcherShardOf(event->type)];
 
-/* ---------- INIT ---------- */
+    DepartmentDescription_t *d = Dept_FromType(event->type); // Registry lookup - one indexed load
 
-void ClientDeptManager_Init(DepartmentDescription_t *pvParameters)
-{
-    DepartmentDescription_t *dept = pvParameters;
-    for (size_t i = 0; i < EVENT_MAX; i++) {
-        dept[i].queue       = DeptQueueFromType(dept[i].type);
-        dept[i].mutex   = DeptMutexFromType(dept[i].type);
-        dept[i].availableSem = DeptAvailSemFromType(dept[i].type);
+    if (d == NULL) { // Invalid event type or department not registered
+        stats->invalid++;
+        printf("[Client][%s] Invalid event type=%d received, discarding\n", pcTaskGetName(NULL), (int)event->type);
+        return; // Skip invalid event
     }
 
-    /* Seed tokens = vehicles available initially */
-    for (int i=0; i<AMBULANCE_VEHICLES; i++) xSemaphoreGive(handleSem_deptAmbulance);
-    for (int i=0; i<POLICE_VEHICLES; i++)    xSemaphoreGive(handleSem_deptPolice);
-    for (int i=0; i<FIRE_VEHICLES; i++)      xSemaphoreGive(handleSem_deptFire);
-    for (int i=0; i<MAINTENANCE_VEHICLES; i++)     xSemaphoreGive(handleSem_deptMaint);
-    for (int i=0; i<WASTE_VEHICLES; i++)     xSemaphoreGive(handleSem_deptWaste);
-    for (int i=0; i<ELECTRICITY_VEHICLES; i++)     xSemaphoreGive(handleSem_deptElect);
+#if COALESCE_ENABLE
+    /* Another report of a live incident - merge it, never give it a queue slot or a vehicle */
+    uint16_t reporters;
+    const uint32_t liveID = Coalesce_Admit(event, &reporters);
+    if (liveID != 0) {
+        stats->coalesced++;
+        PostDroppedCompletion(event, STATUS_COALESCED);
+        printf("[Client][%s] Dept=%s COALESCED id=%u into live incident id=%u ('%s' at %s, reporters=%u)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)event->eventID, (unsigned)liveID,
+               event->event_detail, event->location, (unsigned)reporters);
+        return;
+    }
+#endif
+
+    /* Department priority queue - vehicles always take the most urgent event first.
+       A full queue spills into the department spill store, only a full spill store fails an event. */
+    const uint32_t spilledBefore = d->spill.spilled;
+    EmergencyEvent_t rejected;
+    uint32_t helpers = 0;
+#if MUTUAL_AID_ENABLE
+    helpers = MutualAid_Helpers(event); // Matrix lookup once here - helper vehicles test one bit per queued event
+#endif
+
+    if (Dept_Enqueue(d, event, helpers, &rejected) != pdPASS) {
+        stats->failed++;
+        PostDroppedCompletion(&rejected, STATUS_FAILED);
+        printf("[Client][%s] Dept=%s backlog full (spill cap=%u) -> FAILED event id=%u prio=%u\n",
+               pcTaskGetName(NULL), d->name, (unsigned)DEPT_SPILL_CAP, (unsigned)rejected.eventID, (unsigned)rejected.priority);
+    }
+    else if (d->spill.spilled != spilledBefore) {
+        stats->spilled++;
+        printf("[Client][%s] Dept=%s queue full -> spilled (spill=%u high-water=%u)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)d->spill.count, (unsigned)d->spill.highWater);
+    }
+    stats->routed++;
+    Dept_OnArrival(d);
+
+#if VEHICLE_HANDOFF
+    (void)Vehicle_Handoff(d); // Straight into an idle vehicle's mailbox
+#endif
+#if PREEMPT_ENABLE
+    (void)Vehicle_Preempt(d, event); // Critical event and no free vehicle - take one from a less urgent job
+#endif
+
+    /* Wake the manager when the backlog becomes non-empty or reaches a level its policies act on,
+       and on every arrival while vehicles are on break (the arrival rate may call for a recall) */
+    const UBaseType_t backlog = Dept_Backlog(d);
+    if (backlog == 1 || backlog >= MANAGER_WAKE_BACKLOG || backlog >= d->load.shedAt || d->load.onBreak > 0) {
+        Dept_SignalManager(d, DEPT_SIG_BACKLOG);
+    }
 
-    printf("[Client][ALL MANAGERS] Department array initialized and semaphores seeded\n");
+    printf("[Client][%s] Forwarded id=%u type=%d priority=%u\n",
+           pcTaskGetName(NULL), (unsigned)event->eventID, (int)event->type, (unsigned)event->priority);
 }
 
-
-
-/* ---------- TASKS ---------- */
-
-/* Main Task to handle Dispatcher responsibilities */
+/* Main Task to handle Dispatcher responsibilities - one instance per shard */
 void Task_Dispatcher(void *pvParameters)
 {
-    (void)pvParameters;
-    
-    printf("[Client][DISPATCHER] Started\n");
-    
-
-    for (;;) {
-        EmergencyEvent_t event;
+    const UBaseType_t shard = (UBaseType_t)(uintptr_t)pvParameters;
+    if (shard >= DISPATCHER_SHARDS) {
+        printf("[Client][DISPATCHER] Bad shard=%u -> deleting task\n", (unsigned)shard);
+        vTaskDelete(NULL);
+    }
 
-        /* Wait for incoming event from UDP-RX queue */
-        if (xQueueReceive(handle_clientUDPRxQ, &event, portMAX_DELAY) == pdPASS) {
+    QosLanes_t *lanes = &lanes_clientUDPRx[shard];
+    DispatcherStats_t last = g_dispatcherStats[shard]; // Counters at the start of the report window
+    TickType_t windowStart = xTaskGetTickCount();
 
-            QueueHandle_t queue = DeptQueueFromType(event.type); // Get corresponding department queue
-            SemaphoreHandle_t mutex = DeptMutexFromType(event.type); // Get corresponding department mutex
+    printf("[Client][%s] Started (shard %u of %u)\n", pcTaskGetName(NULL), (unsigned)shard, (unsigned)DISPATCHER_SHARDS);
 
-            if (queue == NULL || mutex == NULL ) { // Invalid event type
-                printf("[Client][DISPATCHER] Invalid event type=%d received, discarding\n", (int)event.type);
-                continue; // Skip invalid event
-            }
+    for (;;) {
+        EmergencyEvent_t event;
 
-            /* Mutex per department queue */
-            xSemaphoreTake(mutex, portMAX_DELAY); // Wait indefinitely for mutex
-            (void)xQueueSend(queue, &event, 0);
-            xSemaphoreGive(mutex);
+        /* Periodic throughput report */
+        const TickType_t now = xTaskGetTickCount();
+        if ((now - windowStart) >= pdMS_TO_TICKS(DISPATCHER_REPORT_MS)) {
+            DispatcherReport(shard, &last, (uint32_t)((now - windowStart) * portTICK_PERIOD_MS));
+            windowStart = now;
+        }
 
-            printf("[Client][DISPATCHER] Forwarded id=%u type=%d priority=%u\n",
-                   (unsigned)event.eventID, (int)event.type, (unsigned)event.priority);
+        /* Wait for incoming event from the UDP-RX lanes of this shard (high lane first) */
+        if (QosLanes_Receive(lanes, &event, pdMS_TO_TICKS(DISPATCHER_REPORT_MS)) == pdPASS) {
+            Dispatcher_Route(&event);
         }
     }
 
     vTaskDelete(NULL); // Should never reach here
 }
 
-static UBaseType_t DeptMaxVehicles(EventType_t type)
+/* Cancel ONE least urgent event currently waiting in the department backlog (latest deadline - the most slack).
+   Takes it from the spill store if anything is spilled, else O(log n) removal from the queue, and sends a "cancelled" completion.
+*/
+static BaseType_t CancelOneLowestPriorityEvent(DepartmentDescription_t *d)
 {
-    switch (type) {
-        case EVENT_AMBULANCE:        return AMBULANCE_VEHICLES;
-        case EVENT_POLICE:           return POLICE_VEHICLES;
-        case EVENT_FIRE_DEPARTMENT:  return FIRE_VEHICLES;
-        case EVENT_MAINTENANCE:      return MAINTENANCE_VEHICLES;
-        case EVENT_WASTE_COLLECTION: return WASTE_VEHICLES;
-        case EVENT_ELECTRICITY:      return ELECTRICITY_VEHICLES;
-        default:                     return 1;
+    EmergencyEvent_t cancelled;
+
+    if (Dept_RemoveLowest(d, &cancelled) != pdPASS) {
+        return pdFALSE; // Backlog empty
     }
+
+    /* Notify server: event was cancelled */
+    PostDroppedCompletion(&cancelled, STATUS_CANCELLED);
+
+    printf("[Client][%s] CANCELLED event id=%u prio=%u (overload)\n",
+           pcTaskGetName(NULL), (unsigned)cancelled.eventID, (unsigned)cancelled.priority);
+
+    return pdTRUE;
 }
 
-/* Cancel ONE lowest-priority event currently waiting in the department queue.
-   Keeps all other events (stable), and sends a "cancelled" completion.
-*/
-static BaseType_t CancelOneLowestPriorityEvent(const DepartmentDescription_t *d)
+#if EVENT_TTL_ENABLE
+/**
+ * @brief TTL sweep - drops the events of the department backlog that waited past their time-to-live and sends
+ *        "expired" completions, so they never take a queue slot or a vehicle again.
+ * @param d - Department
+ * 
+ * @attention This function is static and only used within this file.
+ * @return UBaseType_t Number of events dropped (at most MAX_EXPIRE_PER_CYCLE).
+ */
+static UBaseType_t ExpireStaleEvents(DepartmentDescription_t *d)
 {
-    EmergencyEvent_t buf[DEPT_Q_LEN];
-    UBaseType_t n = 0;
+    EmergencyEvent_t stale;
+    UBaseType_t dropped = 0;
 
-    xSemaphoreTake(d->mutex, portMAX_DELAY);
+    while (dropped < MAX_EXPIRE_PER_CYCLE && Dept_TakeExpired(d, &stale) == pdPASS) {
+        PostDroppedCompletion(&stale, STATUS_EXPIRED);
+        dropped++;
 
-    n = uxQueueMessagesWaiting(d->queue);
-    if (n == 0) {
-        xSemaphoreGive(d->mutex);
-        return pdFALSE;
+        printf("[Client][%s] EXPIRED event id=%u prio=%u Dept=%s (TTL passed, expired=%u)\n",
+               pcTaskGetName(NULL), (unsigned)stale.eventID, (unsigned)stale.priority, d->name, (unsigned)d->expired);
     }
-    if (n > DEPT_Q_LEN) n = DEPT_Q_LEN;
+    return dropped;
+}
+#endif
 
-    /* Drain */
-    for (UBaseType_t i = 0; i < n; i++) {
-        if (xQueueReceive(d->queue, &buf[i], 0) != pdPASS) {
-            n = i;
-            break;
-        }
-    }
+/**
+ * @brief Ticks left until a deadline (0 if it already passed).
+ * @attention This function is static and only used within this file.
+ */
+static TickType_t TicksUntil(TickType_t deadline, TickType_t now)
+{
+    const TickType_t left = deadline - now;
+    return ((int32_t)left > 0) ? left : 0;
+}
+
+/**
+ * @brief Utilization of a department in percent - offered load (service time / inter-arrival time) per active vehicle.
+ * @param arrivalMs - Inter-arrival time estimate (0 = none)
+ * @param serviceMs - Service time estimate (0 = none)
+ * @param active - Vehicles not on break
+ * 
+ * @attention This function is static and only used within this file.
+ * @return uint32_t Utilization in percent, 0 while there is no estimate.
+ */
+static uint32_t LoadUtilPct(uint32_t arrivalMs, uint32_t serviceMs, UBaseType_t active)
+{
+    if (arrivalMs == 0 || serviceMs == 0) return 0;
+    if (active == 0) return UINT32_MAX;
+    return (uint32_t)((uint64_t)serviceMs * 100u / ((uint64_t)arrivalMs * active));
+}
+
+/**
+ * @brief Predicted wait in ms of a backlog (Little's law with the department drain rate).
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t LoadPredictWaitMs(UBaseType_t backlog, uint32_t serviceMs, UBaseType_t active)
+{
+    if (active == 0) return UINT32_MAX;
+    return (uint32_t)((uint64_t)backlog * serviceMs / active);
+}
+
+/**
+ * @brief Adaptive overload threshold - the backlog whose predicted wait reaches LOAD_SHED_WAIT_MS with the whole fleet.
+ * @attention This function is static and only used within this file.
+ */
+static UBaseType_t LoadShedThreshold(uint32_t serviceMs, UBaseType_t vehicles)
+{
+    if (serviceMs == 0) return OVERLOAD_THRESHOLD; // No estimate yet - fixed threshold
+
+    uint64_t shedAt = (uint64_t)LOAD_SHED_WAIT_MS * vehicles / serviceMs;
+    if (shedAt < LOAD_SHED_MIN) shedAt = LOAD_SHED_MIN;
+    if (shedAt > LOAD_SHED_MAX) shedAt = LOAD_SHED_MAX;
+    return (UBaseType_t)shedAt;
+}
 
-    /* Find lowest priority (priority: 1 low, 3 high) */
-    UBaseType_t cancelIdx = 0;
-    uint8_t minPrio = buf[0].priority;
-    for (UBaseType_t i = 1; i < n; i++) {
-        if (buf[i].priority < minPrio) {
-            minPrio = buf[i].priority;
-            cancelIdx = i;
+/* Policy state of one department - owned by its manager task, or by the supervisor (MANAGER_SUPERVISOR=1) */
+typedef struct {
+    DepartmentDescription_t *d;
+    UBaseType_t breakCount;         // How many tokens we “stole” for break (vehicles unavailable by policy)
+    TickType_t  lastNonEmptyTick;   // Backlog was last seen non-empty
+    TickType_t  saturatedSince;     // Mutual aid - tick the backlog started waiting with no free vehicle
+    uint32_t    wakes;              // Policy runs (metric)
+    TickType_t  lastFleetReport;    // Utilization report (FleetStats_Report) was last printed
+    TickType_t  waitHighSince;      // Autoscaler - tick the predicted wait went above AUTOSCALE_UP_WAIT_MS (0 = below)
+    TickType_t  lastScale;          // Autoscaler - fleet size last changed (or manager start)
+    TickType_t  nextSweep;          // TTL sweep - tick of the next backlog scan (EVENT_TTL_SWEEP_MS apart)
+} ManagerState_t;
+
+#if AUTOSCALE_ENABLE
+/**
+ * @brief Fleet autoscaling - adds a vehicle while the predicted wait stays high, retires one after sustained idleness.
+ *        One vehicle per hold period either way, always within the fleet bounds of the department.
+ * @param st - Policy state of the department
+ * @param qLen - Backlog
+ * @param arrivalMs - Mean inter-arrival time estimate (0 = none yet)
+ * @param serviceMs - Mean service time estimate (0 = none yet)
+ * @param now - Current tick
+ * 
+ * @attention This function is static and only used within this file.
+ * @return TickType_t Ticks until the autoscaler must run again without a signal (portMAX_DELAY = only on a signal).
+ */
+static TickType_t ManagerAutoscale(ManagerState_t *st, UBaseType_t qLen, uint32_t arrivalMs, uint32_t serviceMs, TickType_t now)
+{
+    DepartmentDescription_t *d = st->d;
+    const UBaseType_t active = d->vehicles;
+    const uint32_t waitMs = LoadPredictWaitMs(qLen, serviceMs, active);
+
+    /* Scale up - the predicted wait stayed high for a whole hold period */
+    if (waitMs >= AUTOSCALE_UP_WAIT_MS) {
+        const TickType_t hold = pdMS_TO_TICKS(AUTOSCALE_UP_HOLD_MS);
+
+        if (st->waitHighSince == 0) st->waitHighSince = now ? now : 1;
+        if ((now - st->waitHighSince) < hold) return TicksUntil(st->waitHighSince + hold, now);
+        if (active >= d->maxVehicles) return portMAX_DELAY; // At the limit - shedding and mutual aid take over
+
+        if (Vehicle_Activate(d) == pdTRUE) {
+            st->waitHighSince = now ? now : 1; // Next vehicle only after another hold period
+            st->lastScale = now;
+            printf("[Client][%s] Dept=%s SCALE UP -> %u vehicles (predicted wait=%ums backlog=%u service=%ums, max %u)\n",
+                   pcTaskGetName(NULL), d->name, (unsigned)d->vehicles, (unsigned)waitMs, (unsigned)qLen,
+                   (unsigned)serviceMs, (unsigned)d->maxVehicles);
+            return hold;
         }
+        return portMAX_DELAY;
     }
+    st->waitHighSince = 0;
 
-    EmergencyEvent_t cancelled = buf[cancelIdx];
+    /* Scale down - the backlog stayed empty (and the fleet size unchanged) for a whole idle period */
+    if (qLen > 0 || active <= d->minVehicles) return portMAX_DELAY;
 
-    /* Requeue everything except cancelled */
-    for (UBaseType_t i = 0; i < n; i++) {
-        if (i == cancelIdx) continue;
-        (void)xQueueSend(d->queue, &buf[i], 0);
+    const TickType_t idle = pdMS_TO_TICKS(AUTOSCALE_DOWN_IDLE_MS);
+    const TickType_t quietSince = ((int32_t)(st->lastScale - st->lastNonEmptyTick) > 0) ? st->lastScale : st->lastNonEmptyTick;
+    if ((now - quietSince) < idle) return TicksUntil(quietSince + idle, now);
+    if (LoadUtilPct(arrivalMs, serviceMs, active - 1) >= AUTOSCALE_DOWN_UTIL_PCT) {
+        return idle; // Re-check once the arrival estimate has decayed
     }
 
-    xSemaphoreGive(d->mutex);
+    /* Destroy one vehicle token - a break token, or a free one through the gate */
+    if (st->breakCount > 0) {
+        (void)Dept_FleetShrink(d, pdTRUE);
+        st->breakCount--;
+    }
+    else if (Dept_FleetShrink(d, pdFALSE) != pdPASS) {
+        return portMAX_DELAY; // Every vehicle is busy - a vehicle finishing signals us
+    }
 
-    /* Notify server: event was cancelled */
-    CompletionMsg_t msg = {0};
-    msg.eventID = cancelled.eventID;
-    msg.status  = STATUS_CANCELLED;
-    msg.timestampEnd = xTaskGetTickCount(); /* ok for demo */
+    (void)Vehicle_Retire(d); // Above minVehicles - only this manager changes the fleet size
+    st->lastScale = now;
+    printf("[Client][%s] Dept=%s SCALE DOWN -> %u vehicles (idle %ums util=%u%%, min %u)\n",
+           pcTaskGetName(NULL), d->name, (unsigned)d->vehicles, (unsigned)((now - quietSince) * portTICK_PERIOD_MS),
+           (unsigned)LoadUtilPct(arrivalMs, serviceMs, d->vehicles), (unsigned)d->minVehicles);
+    return idle;
+}
+#endif
 
-    /* IMPORTANT: snprintf must use "%s" format */
-    snprintf(msg.handledBy, sizeof(msg.handledBy), "%s", pcTaskGetName(NULL));
+/**
+ * @brief Runs the manager policies of one department once: refill, TTL sweep, load estimates, mutual aid, overload, break and autoscaling.
+ * @param st - Policy state of the department
+ * 
+ * @attention This function is static and only used within this file.
+ * @return TickType_t Ticks until the policies must run again without a signal (portMAX_DELAY = only on a signal).
+ */
+static TickType_t ManagerStep(ManagerState_t *st)
+{
+    DepartmentDescription_t *d = st->d;
+    const UBaseType_t maxVehicles = d->vehicles;
+    const UBaseType_t maxBreak = (maxVehicles * BREAK_MAX_FRACTION_NUM) / BREAK_MAX_FRACTION_DEN;
 
-    (void)xQueueSend(handle_clientUDPTxQ, &msg, 0);
+    st->wakes++;
+    Dept_Refill(d); // Space freed by vehicles or cancellations - pull spilled events back
 
-    printf("[Client][%s] CANCELLED event id=%u prio=%u (overload)\n",
-           pcTaskGetName(NULL), (unsigned)cancelled.eventID, (unsigned)cancelled.priority);
+    TickType_t now = xTaskGetTickCount();
 
-    return pdTRUE;
-}
+#if EVENT_TTL_ENABLE
+    /* ---------------- TTL sweep - stale events leave before they count as backlog ---------------- */
+    if ((int32_t)(now - st->nextSweep) >= 0) { // Scans the whole backlog - on its own period, not on every wake
+        const UBaseType_t expired = ExpireStaleEvents(d);
+        /* A full batch leaves more to drop - the next batch follows after MANAGER_POLL_MS */
+        st->nextSweep = now + pdMS_TO_TICKS((expired >= MAX_EXPIRE_PER_CYCLE) ? MANAGER_POLL_MS : EVENT_TTL_SWEEP_MS);
+    }
+#endif
+    const UBaseType_t qLen = Dept_Backlog(d);
+
+    /* ---------------- Load estimates -> adaptive thresholds ---------------- */
+    uint32_t arrivalMs, serviceMs;
+    Dept_LoadEstimate(d, &arrivalMs, &serviceMs);
+
+    const UBaseType_t shedAt = LoadShedThreshold(serviceMs, maxVehicles);
+    UBaseType_t shedTarget = shedAt * OVERLOAD_TARGET / OVERLOAD_THRESHOLD;
+    if (shedTarget == 0) shedTarget = 1;
+
+    if (shedAt != d->load.shedAt) {
+        d->load.shedAt = shedAt;
+        printf("[Client][%s] Dept=%s load: arrival=%ums service=%ums util=%u%% -> overload at backlog %u (target %u)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)arrivalMs, (unsigned)serviceMs,
+               (unsigned)LoadUtilPct(arrivalMs, serviceMs, maxVehicles), (unsigned)shedAt, (unsigned)shedTarget);
+    }
 
-/* Reorder queue by priority (high first), stable within same priority.
-   This is the simplest “reassign” without per-vehicle inbox queues.
-*/
-static void ReorderQueueByPriority(const DepartmentDescription_t *d)
-{
-    EmergencyEvent_t buf[DEPT_Q_LEN];
-    UBaseType_t n = 0;
+#if MUTUAL_AID_ENABLE
+    /* ---------------- Mutual aid request ---------------- */
+    MutualAid_UpdateRequest(d, qLen, &st->saturatedSince);
+#endif
 
-    xSemaphoreTake(d->mutex, portMAX_DELAY);
+    /* ---------------- Overload policy ---------------- */
+    if (qLen >= shedAt) {
 
-    n = uxQueueMessagesWaiting(d->queue);
-    if (n == 0) {
-        xSemaphoreGive(d->mutex);
-        return;
+        /* Ensure no one is on break during overload */
+        while (st->breakCount > 0) {
+            Dept_BreakEnd(d, 1);
+            st->breakCount--;
+            printf("[Client][%s] Dept=%s -> RETURN from break (breakCount=%u)\n",
+                   pcTaskGetName(NULL), d->name, (unsigned)st->breakCount);
+        }
+
+        printf("[Client][%s] Dept=%s OVERLOAD backlog=%u predicted wait=%ums (limit %ums)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)qLen,
+               (unsigned)LoadPredictWaitMs(qLen, serviceMs, maxVehicles), (unsigned)LOAD_SHED_WAIT_MS);
+
+        /* Cancel lowest-priority events until we reduce backlog */
+        UBaseType_t cancelDone = 0;
+        while (Dept_Backlog(d) > shedTarget &&
+               cancelDone < MAX_CANCEL_PER_CYCLE) {
+
+            if (CancelOneLowestPriorityEvent(d) == pdTRUE) {
+                cancelDone++;
+            } else {
+                break;
+            }
+        }
     }
-    if (n > DEPT_Q_LEN) n = DEPT_Q_LEN;
 
-    for (UBaseType_t i = 0; i < n; i++) {
-        if (xQueueReceive(d->queue, &buf[i], 0) != pdPASS) {
-            n = i;
-            break;
+    /* ---------------- Break / return policy (simple) ----------------
+       If system is idle (queue empty for some time), allow some vehicles “on break”.
+       If queue has work and we have break tokens -> return them immediately.
+    */
+    TickType_t breakWait = portMAX_DELAY; // Next time the break policy needs to run without a signal
+
+    /* Predictive recall - the arrival rate needs the vehicles on break before a backlog builds up */
+    if (st->breakCount > 0 && LoadUtilPct(arrivalMs, serviceMs, maxVehicles - st->breakCount) >= LOAD_RECALL_UTIL_PCT) {
+        printf("[Client][%s] Dept=%s -> RECALL %u from break (util=%u%% with %u active)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)st->breakCount,
+               (unsigned)LoadUtilPct(arrivalMs, serviceMs, maxVehicles - st->breakCount),
+               (unsigned)(maxVehicles - st->breakCount));
+        while (st->breakCount > 0) {
+            Dept_BreakEnd(d, 1);
+            st->breakCount--;
         }
     }
 
-    /* Stable insertion sort: higher priority first */
-    for (UBaseType_t i = 1; i < n; i++) {
-        EmergencyEvent_t key = buf[i];
-        int j = (int)i - 1;
-        while (j >= 0 && buf[j].priority < key.priority) {
-            buf[j + 1] = buf[j];
-            j--;
+    if (qLen > 0) {
+        st->lastNonEmptyTick = now;
+    
+        /* If backlog exists, immediately return all vehicles from break */
+        while (st->breakCount > 0) {
+            Dept_BreakEnd(d, 1);
+            st->breakCount--;
+            printf("[Client][%s] Dept=%s -> RETURN from break (breakCount=%u)\n",
+                   pcTaskGetName(NULL), d->name, (unsigned)st->breakCount);
+        }
+    }
+    else {
+        /* Queue empty */
+        const BaseType_t idleLongEnough =
+            (now - st->lastNonEmptyTick) >= pdMS_TO_TICKS(BREAK_IDLE_MS);
+
+        /* Only if the remaining vehicles can carry the measured load */
+        const BaseType_t loadAllowsBreak =
+            LoadUtilPct(arrivalMs, serviceMs, maxVehicles - st->breakCount - 1) < LOAD_BREAK_UTIL_PCT;
+    
+        if (st->breakCount >= maxBreak) {
+            /* Break quota used - nothing to wait for */
+        }
+        else if (!idleLongEnough) {
+            breakWait = TicksUntil(st->lastNonEmptyTick + pdMS_TO_TICKS(BREAK_IDLE_MS), now); // Not idle long enough yet
+        }
+        else if (!loadAllowsBreak) {
+            breakWait = pdMS_TO_TICKS(BREAK_IDLE_MS); // Re-check once the arrival estimate has decayed
+        }
+        else if (Dept_BreakStart(d) == pdPASS) {
+            st->breakCount++;
+            breakWait = 0; // Next vehicle may go right away
+            printf("[Client][%s] Dept=%s -> vehicle ON BREAK (breakCount=%u wakes=%u)\n",
+                   pcTaskGetName(NULL), d->name, (unsigned)st->breakCount, (unsigned)st->wakes);
         }
-        buf[j + 1] = key;
+        /* else: every vehicle is busy - a vehicle finishing signals us */
     }
 
-    for (UBaseType_t i = 0; i < n; i++) {
-        (void)xQueueSend(d->queue, &buf[i], 0);
+#if AUTOSCALE_ENABLE
+    /* ---------------- Fleet autoscaling ---------------- */
+    const TickType_t scaleWait = ManagerAutoscale(st, qLen, arrivalMs, serviceMs, now);
+#endif
+
+    d->load.onBreak = st->breakCount;
+    FleetStats_SetOnBreak(d, st->breakCount);
+
+#if VEHICLE_HANDOFF
+    (void)Vehicle_Handoff(d); // Vehicles returned from break (or added by the autoscaler) can take waiting events
+#endif
+
+    /* ---------------- Sleep until a signal or the next policy deadline ---------------- */
+    TickType_t wait = breakWait;
+#if AUTOSCALE_ENABLE
+    if (scaleWait < wait) wait = scaleWait;
+#endif
+
+    if (Dept_Backlog(d) >= shedAt && pdMS_TO_TICKS(MANAGER_POLL_MS) < wait) {
+        wait = pdMS_TO_TICKS(MANAGER_POLL_MS); // Still overloaded - next cancel batch
     }
 
-    xSemaphoreGive(d->mutex);
+#if EVENT_TTL_ENABLE
+    if (Dept_Backlog(d) > 0) { // Waiting events may expire - next sweep
+        const TickType_t sweepWait = TicksUntil(st->nextSweep, now);
+        if (sweepWait < wait) wait = sweepWait;
+    }
+#endif
 
-    printf("[Client][%s] Reordered queue by priority (n=%u)\n",
-           pcTaskGetName(NULL), (unsigned)n);
+#if FLEET_STATS_REPORT_MS
+    /* ---------------- Periodic utilization export ---------------- */
+    if ((now - st->lastFleetReport) >= pdMS_TO_TICKS(FLEET_STATS_REPORT_MS)) {
+        FleetStats_Report(d);
+        st->lastFleetReport = now;
+    }
+    const TickType_t reportWait = TicksUntil(st->lastFleetReport + pdMS_TO_TICKS(FLEET_STATS_REPORT_MS), now);
+    if (reportWait < wait) wait = reportWait;
+#endif
+
+#if MUTUAL_AID_ENABLE
+    if (st->saturatedSince != 0 && !d->aidWanted) { // Saturated, aid not requested yet - wake when the wait expires
+        const TickType_t aidWait = TicksUntil(st->saturatedSince + pdMS_TO_TICKS(MUTUAL_AID_WAIT_MS), now);
+        if (aidWait < wait) wait = aidWait;
+    }
+#endif
+
+    return wait;
+}
+
+/**
+ * @brief Initializes the policy state of one department and publishes its initial thresholds.
+ * @attention This function is static and only used within this file.
+ */
+static void ManagerStateInit(ManagerState_t *st, DepartmentDescription_t *d)
+{
+    memset(st, 0, sizeof(*st));
+    st->d = d;
+    st->lastNonEmptyTick = xTaskGetTickCount();
+    st->lastFleetReport  = st->lastNonEmptyTick;
+    st->lastScale        = st->lastNonEmptyTick;
+    st->nextSweep        = st->lastNonEmptyTick + pdMS_TO_TICKS(EVENT_TTL_SWEEP_MS);
+
+    d->load.shedAt  = OVERLOAD_THRESHOLD;
+    d->load.onBreak = 0;
 }
 
 // TODO: Task_Manager_Departments_X
@@ -277,95 +571,100 @@ static void ReorderQueueByPriority(const DepartmentDescription_t *d)
 void Task_Manager_Departments_X(void *pvParameters)
 {
     DepartmentDescription_t *d = (DepartmentDescription_t *)pvParameters;
-    if (d == NULL || d->queue == NULL || d->mutex == NULL || d->availableSem == NULL) {
+    if (d == NULL || d->queue == NULL || d->availableSem == NULL) {
         printf("[Client][MANAGER] Bad params -> deleting task\n");
         vTaskDelete(NULL);
     }
 
-    const UBaseType_t maxVehicles = DeptMaxVehicles(d->type);
-
-    /* How many tokens we “stole” for break (vehicles unavailable by policy) */
-    UBaseType_t breakCount = 0;
-
-    TickType_t lastBusyTick = xTaskGetTickCount();
+    ManagerState_t st; // Policy state of this department
+    ManagerStateInit(&st, d);
+    d->manager = xTaskGetCurrentTaskHandle(); // Dept_SignalManager() wakes this task from now on
 
-    printf("[Client][%s] Started (dept=%s maxVehicles=%u)\n",
-           pcTaskGetName(NULL), d->name, (unsigned)maxVehicles);
+    printf("[Client][%s] Started (dept=%s vehicles=%u min=%u max=%u)\n",
+           pcTaskGetName(NULL), d->name, (unsigned)d->vehicles, (unsigned)d->minVehicles, (unsigned)d->maxVehicles);
 
     for (;;) {
-        const UBaseType_t qLen = uxQueueMessagesWaiting(d->queue);
+        const TickType_t wait = ManagerStep(&st);
+        (void)xTaskNotifyWait(0, UINT32_MAX, NULL, wait); // DEPT_SIG_xxx - any signal re-runs the policies
+    }
 
-        if (qLen > 0) {
-            lastBusyTick = xTaskGetTickCount();
-        }
+    vTaskDelete(NULL); // Should never reach here
+}
 
-        /* ---------------- Overload policy ---------------- */
-        if (qLen >= OVERLOAD_THRESHOLD) {
+#if MANAGER_SUPERVISOR
+void Task_Supervisor(void *pvParameters)
+{
+    (void)pvParameters;
 
-            /* Ensure no one is on break during overload */
-            while (breakCount > 0) {
-                xSemaphoreGive(d->availableSem);
-                breakCount--;
-                printf("[Client][%s] Dept=%s -> RETURN from break (breakCount=%u)\n",
-                       pcTaskGetName(NULL), d->name, (unsigned)breakCount);
-            }
+    static ManagerState_t states[DEPT_REGISTRY_MAX]; // Policy state per department - static, too large for the task stack
+    TickType_t nextRun[DEPT_REGISTRY_MAX];           // Policy deadline per department
+    BaseType_t hasDeadline[DEPT_REGISTRY_MAX];
+    UBaseType_t count = 0;
 
-            /* Reorder so vehicles will take high priority first */
-            ReorderQueueByPriority(d);
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        if (Dept_FromType((EventType_t)t) != NULL) count++;
+    }
 
-            /* Cancel lowest-priority events until we reduce backlog */
-            UBaseType_t cancelDone = 0;
-            while (uxQueueMessagesWaiting(d->queue) > OVERLOAD_TARGET &&
-                   cancelDone < MAX_CANCEL_PER_CYCLE) {
+    /* One binary signal semaphore per department, all in one queue set - the set must be built while they are empty */
+    QueueSetHandle_t set = (count > 0) ? xQueueCreateSet(count) : NULL;
+    if (set == NULL) {
+        printf("[Client][SUPERVISOR] No departments or queue set allocation failed -> deleting task\n");
+        vTaskDelete(NULL);
+    }
 
-                if (CancelOneLowestPriorityEvent(d) == pdTRUE) {
-                    cancelDone++;
-                } else {
-                    break;
-                }
-            }
-        }
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        hasDeadline[t] = pdFALSE;
+        if (d == NULL) continue;
 
-        /* ---------------- Break / return policy (simple) ----------------
-           If system is idle (queue empty for some time), allow some vehicles “on break”.
-           If queue has work and we have break tokens -> return them immediately.
-        */
-        static TickType_t lastNonEmptyTick = 0;
+        ManagerStateInit(&states[t], d);
 
-        if (lastNonEmptyTick == 0) {
-            lastNonEmptyTick = xTaskGetTickCount();
+        SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+        if (sem == NULL || xQueueAddToSet(sem, set) != pdPASS) {
+            printf("[Client][SUPERVISOR] Failed to create the signal of Dept=%s -> deleting task\n", d->name);
+            vTaskDelete(NULL);
         }
+        d->signalSem = sem; // Dept_SignalManager() gives it from now on
+        hasDeadline[t] = pdTRUE; // First run right away
+        nextRun[t] = xTaskGetTickCount();
+    }
 
-        TickType_t now = xTaskGetTickCount();
+    printf("[Client][SUPERVISOR] Started (%u departments, one queue set)\n", (unsigned)count);
 
-        if (qLen > 0) {
-            lastNonEmptyTick = now;
-        
-            /* If backlog exists, immediately return all vehicles from break */
-            while (breakCount > 0) {
-                xSemaphoreGive(d->availableSem);
-                breakCount--;
-                printf("[Client][%s] Dept=%s -> RETURN from break (breakCount=%u)\n",
-                       pcTaskGetName(NULL), d->name, (unsigned)breakCount);
+    for (;;) {
+        /* ---------------- Run every department that was signalled or reached its deadline ---------------- */
+        QueueSetMemberHandle_t member;
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = portMAX_DELAY;
+
+        for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+            if (!hasDeadline[t]) continue;
+
+            TickType_t left = TicksUntil(nextRun[t], now);
+            if (left == 0) {
+                left = ManagerStep(&states[t]);
+                now = xTaskGetTickCount();
+                hasDeadline[t] = (left != portMAX_DELAY);
+                nextRun[t] = now + left;
+                if (!hasDeadline[t]) continue;
             }
+            if (left < wait) wait = left;
         }
-        else {
-            /* Queue empty */
-            const BaseType_t idleLongEnough =
-                (now - lastNonEmptyTick) >= pdMS_TO_TICKS(BREAK_IDLE_MS);
-        
-            const UBaseType_t maxBreak = (maxVehicles * BREAK_MAX_FRACTION_NUM) / BREAK_MAX_FRACTION_DEN;
-        
-            if (idleLongEnough && breakCount < maxBreak) {
-                if (xSemaphoreTake(d->availableSem, 0) == pdPASS) {
-                    breakCount++;
-                    printf("[Client][%s] Dept=%s -> vehicle ON BREAK (breakCount=%u)\n",
-                           pcTaskGetName(NULL), d->name, (unsigned)breakCount);
-                }
-            }
+
+        member = xQueueSelectFromSet(set, wait);
+        if (member == NULL) continue; // Deadline - handled at the top of the loop
+
+        (void)xSemaphoreTake((SemaphoreHandle_t)member, 0); // Must succeed - the set said it is available
+
+        for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+            if (states[t].d == NULL || states[t].d->signalSem != (SemaphoreHandle_t)member) continue;
+
+            hasDeadline[t] = pdTRUE; // Signalled - run now
+            nextRun[t] = xTaskGetTickCount();
+            break;
         }
     }
-    
-        vTaskDelete(NULL); // Should never reach here
 
-}
\ No newline at end of file
+    vTaskDelete(NULL); // Should never reach here
+}
+#endif // MANAGER_SUPERVISOR
@@ -0,0 +1,156 @@
+/**
+ * @file FleetStats.c
+ * @brief Implementation of the fleet utilization accounting (per-vehicle activity time, department break time, report).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#include "Client/FleetStats.h"
+
+#include <stdio.h>
+
+
+static const char *const activityNames[VEHICLE_ACTIVITY_MAX] = { "IDLE", "WAITING", "BUSY", "RETIRED" };
+
+
+/**
+ * @brief Milliseconds between two ticks.
+ * @attention This function is static and only used within this file.
+ */
+static uint64_t TicksToMs(TickType_t from, TickType_t to)
+{
+    return (uint64_t)(TickType_t)(to - from) * portTICK_PERIOD_MS;
+}
+
+/**
+ * @brief Share of a time in a total, in percent.
+ * @attention This function is static and only used within this file.
+ */
+static unsigned Pct(uint64_t part, uint64_t total)
+{
+    return total ? (unsigned)(part * 100u / total) : 0;
+}
+
+
+void FleetStats_SetActivity(VehicleState_t *v, VehicleActivity_t activity)
+{
+    VehicleStats_t *st = &v->stats;
+    const TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    if (st->activity != activity) {
+        st->ms[st->activity] += TicksToMs(st->since, now);
+        if (st->activity == VEHICLE_BUSY) {
+            st->jobs++;
+            if (v->units > 1) st->gangMs += (uint64_t)(v->units - 1) * TicksToMs(st->since, now);
+        }
+        st->activity = activity;
+        st->since = now;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void FleetStats_SetOnBreak(DepartmentDescription_t *d, UBaseType_t onBreak)
+{
+    DeptBreakStats_t *b = &d->breakStats;
+    const TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    if (b->onBreak != onBreak) {
+        b->ms += (uint64_t)b->onBreak * TicksToMs(b->since, now);
+        b->onBreak = onBreak;
+        b->since = now;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void FleetStats_Vehicle(const VehicleState_t *v, VehicleStats_t *out)
+{
+    const TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    *out = v->stats;
+    const UBaseType_t units = v->units;
+    taskEXIT_CRITICAL();
+
+    out->ms[out->activity] += TicksToMs(out->since, now); // Running interval up to now
+    if (out->activity == VEHICLE_BUSY && units > 1) out->gangMs += (uint64_t)(units - 1) * TicksToMs(out->since, now);
+    out->since = now;
+}
+
+void FleetStats_Dept(const DepartmentDescription_t *d, DeptStats_t *out)
+{
+    const TickType_t now = xTaskGetTickCount();
+    VehicleStats_t vs;
+
+    *out = (DeptStats_t){0};
+    out->vehicles = d->vehicles;
+
+    for (UBaseType_t i = 0; i < d->vehicles; i++) {
+        FleetStats_Vehicle(&d->fleet[i], &vs);
+        for (UBaseType_t a = 0; a < VEHICLE_ACTIVITY_MAX; a++) out->ms[a] += vs.ms[a];
+        out->gangMs += vs.gangMs;
+        out->jobs += vs.jobs;
+        out->now[vs.activity]++;
+    }
+
+    taskENTER_CRITICAL();
+    const DeptBreakStats_t b = d->breakStats;
+    taskEXIT_CRITICAL();
+
+    out->breakMs = b.ms + (uint64_t)b.onBreak * TicksToMs(b.since, now);
+    out->onBreak = b.onBreak;
+    out->capacity = Dept_Ledger(d, &out->tokens);
+}
+
+void FleetStats_Report(const DepartmentDescription_t *d)
+{
+    DeptStats_t ds;
+    FleetStats_Dept(d, &ds);
+
+    const uint64_t fleetMs = ds.ms[VEHICLE_IDLE] + ds.ms[VEHICLE_WAITING] + ds.ms[VEHICLE_BUSY];
+    const uint64_t elapsedMs = fleetMs / ds.vehicles;
+    if (elapsedMs == 0) return; // Nothing accounted yet
+
+    /* Tokens held for breaks and gangs keep other vehicles of the fleet idle (or waiting at the reservation gate):
+       take that vehicle-time out of their idle time, then their waiting time, so the shares add up to 100% */
+    uint64_t idleMs = ds.ms[VEHICLE_IDLE];
+    uint64_t waitingMs = ds.ms[VEHICLE_WAITING];
+    uint64_t heldMs = ds.breakMs + ds.gangMs;
+    const uint64_t fromIdle = (heldMs < idleMs) ? heldMs : idleMs;
+    idleMs -= fromIdle;
+    heldMs -= fromIdle;
+    waitingMs -= (heldMs < waitingMs) ? heldMs : waitingMs;
+
+    /* Right-sizing - vehicles that would carry the busy time (gang tokens included) at the target utilization (rounded up) */
+    const uint64_t busyMs = ds.ms[VEHICLE_BUSY] + ds.gangMs;
+    const uint64_t needed = (busyMs * 100u + elapsedMs * FLEET_STATS_TARGET_UTIL_PCT - 1) /
+                            (elapsedMs * FLEET_STATS_TARGET_UTIL_PCT);
+
+    printf("[Client][%s] FLEET Dept=%s vehicles=%u busy=%u%% gang=%u%% idle=%u%% waiting=%u%% break=%u%% "
+           "jobs=%u avgService=%ums now(busy=%u waiting=%u break=%u) needed@%u%%=%u "
+           "tokens(free=%u busy=%u break=%u) capacity=%u/%u%s\n",
+           pcTaskGetName(NULL), d->name, (unsigned)ds.vehicles,
+           Pct(ds.ms[VEHICLE_BUSY], fleetMs), Pct(ds.gangMs, fleetMs), Pct(idleMs, fleetMs),
+           Pct(waitingMs, fleetMs), Pct(ds.breakMs, fleetMs),
+           (unsigned)ds.jobs, (unsigned)(ds.jobs ? ds.ms[VEHICLE_BUSY] / ds.jobs : 0),
+           (unsigned)ds.now[VEHICLE_BUSY], (unsigned)ds.now[VEHICLE_WAITING], (unsigned)ds.onBreak,
+           (unsigned)FLEET_STATS_TARGET_UTIL_PCT, (unsigned)needed,
+           (unsigned)ds.tokens.count[DEPT_TOKEN_AVAILABLE], (unsigned)ds.tokens.count[DEPT_TOKEN_BUSY],
+           (unsigned)ds.tokens.count[DEPT_TOKEN_BREAK], (unsigned)ds.capacity, (unsigned)ds.vehicles,
+           (ds.capacity == ds.vehicles && ds.tokens.total == ds.vehicles) ? "" : " CAPACITY DRIFT");
+
+    if (d->vehicles > FLEET_STATS_VEHICLE_LINES) return; // City-scale fleet - department line only
+
+    for (UBaseType_t i = 0; i < d->vehicles; i++) {
+        VehicleStats_t vs;
+        FleetStats_Vehicle(&d->fleet[i], &vs);
+        const uint64_t totalMs = vs.ms[VEHICLE_IDLE] + vs.ms[VEHICLE_WAITING] + vs.ms[VEHICLE_BUSY];
+
+        printf("[Client][%s] FLEET   %s_%u %s busy=%u%% idle=%u%% waiting=%u%% jobs=%u avgService=%ums\n",
+               pcTaskGetName(NULL), d->name, (unsigned)(i + 1), activityNames[vs.activity],
+               Pct(vs.ms[VEHICLE_BUSY], totalMs), Pct(vs.ms[VEHICLE_IDLE], totalMs),
+               Pct(vs.ms[VEHICLE_WAITING], totalMs),
+               (unsigned)vs.jobs, (unsigned)(vs.jobs ? vs.ms[VEHICLE_BUSY] / vs.jobs : 0));
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * @file Location.c
+ * @brief Implementation of the Client location model (parsing and the precomputed travel time matrix).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#include "Client/Location.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Travel time matrix in ms - filled once by Location_Init, read-only afterwards */
+static uint16_t travelMs[LOCATION_COUNT][LOCATION_COUNT];
+
+
+void Location_Init(void)
+{
+    for (int from = 0; from < LOCATION_COUNT; from++) {
+        for (int to = 0; to < LOCATION_COUNT; to++) {
+            const int dx = abs((from % LOCATION_GRID_W) - (to % LOCATION_GRID_W));
+            const int dy = abs((from / LOCATION_GRID_W) - (to / LOCATION_GRID_W));
+            travelMs[from][to] = (uint16_t)((dx + dy) * TRAVEL_MS_PER_BLOCK);
+        }
+    }
+
+    printf("[Client][LOCATION] Travel time matrix ready (%d locations, %d ms per block)\n",
+           LOCATION_COUNT, TRAVEL_MS_PER_BLOCK);
+}
+
+uint8_t Location_Parse(const char *location)
+{
+    static const char prefix[] = "Street ";
+
+    if (strncmp(location, prefix, sizeof(prefix) - 1) != 0) return LOCATION_UNKNOWN;
+
+    char *end = NULL;
+    unsigned long n = strtoul(location + sizeof(prefix) - 1, &end, 10);
+    if (end == location + sizeof(prefix) - 1 || n >= LOCATION_COUNT) return LOCATION_UNKNOWN;
+
+    return (uint8_t)n;
+}
+
+uint32_t Location_TravelMs(uint8_t from, uint8_t to)
+{
+    if (from >= LOCATION_COUNT || to >= LOCATION_COUNT) return TRAVEL_MS_UNKNOWN;
+    return travelMs[from][to];
+}
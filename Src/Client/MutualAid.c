@@ -0,0 +1,159 @@
+/**
+ * @file MutualAid.c
+ * @brief Implementation of cross-department mutual aid (capability matrix, aid request and work pulling).
+ *
+ * @attention This file is part of the Client module.
+ */
+
+#include "Client/MutualAid.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/* Capability Matrix - which department can serve which catalog items of another department (see eventCatalog) */
+const MutualAidCapability_t mutualAidMatrix[] = {
+
+    /* Ambulance - Police units carry first aid kits */
+    { EVENT_AMBULANCE,        "Minor injury",                        EVENT_POLICE,      50 },
+    { EVENT_AMBULANCE,        "Minor accident",                      EVENT_POLICE,      80 },
+    /* Police */
+    { EVENT_POLICE,           "City emergency assistance",           EVENT_MAINTENANCE, 50 },
+    /* Fire */
+    { EVENT_FIRE_DEPARTMENT,  "Suspicious smoke",                    EVENT_POLICE,      50 },
+    { EVENT_FIRE_DEPARTMENT,  "Open field fire",                     EVENT_MAINTENANCE, 100 },
+    /* Maintenance */
+    { EVENT_MAINTENANCE,      "Dangerous sewer openings",            EVENT_POLICE,      30 },
+    { EVENT_MAINTENANCE,      "Routine public building maintenance", EVENT_ELECTRICITY, 50 },
+    /* Waste */
+    { EVENT_WASTE_COLLECTION, "Regular bin collection",              EVENT_MAINTENANCE, 50 },
+    { EVENT_WASTE_COLLECTION, "Full neighborhood bins",              EVENT_MAINTENANCE, 80 },
+    /* Electricity */
+    { EVENT_ELECTRICITY,      "Streetlight failure",                 EVENT_MAINTENANCE, 50 },
+    { EVENT_ELECTRICITY,      "Traffic light signaling failure",     EVENT_MAINTENANCE, 80 },
+};
+
+const uint32_t mutualAidMatrixCount = (uint32_t)(sizeof(mutualAidMatrix)/sizeof(mutualAidMatrix[0])); // Number of rows in the matrix
+
+
+/**
+ * @brief Finds the matrix row for an event of 'owner' served by 'helper'.
+ * @param detail - Event detail, or NULL to match any row of the owner/helper pair
+ * @attention This function is static and only used within this file.
+ * @return const MutualAidCapability_t* Matching row, or NULL if the helper cannot serve it.
+ */
+static const MutualAidCapability_t *FindCapability(EventType_t owner, const char *detail, EventType_t helper)
+{
+    for (uint32_t i = 0; i < mutualAidMatrixCount; i++) {
+        const MutualAidCapability_t *c = &mutualAidMatrix[i];
+        if (c->owner == owner && c->helper == helper &&
+            (detail == NULL || strncmp(c->detail, detail, sizeof(((EmergencyEvent_t *)0)->event_detail)) == 0)) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Dept_TakeIf predicate - pdTRUE if the helper department (context) can serve the job (DeptJob_t.helpers).
+ *        Events past their TTL are never lent out - the owner's manager drops them (Dept_TakeExpired).
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t HelperCanServe(const void *pvItem, void *pvContext)
+{
+    const DeptJob_t *job = (const DeptJob_t *)pvItem;
+    const DepartmentDescription_t *helper = (const DepartmentDescription_t *)pvContext;
+
+    if ((job->helpers & (1u << helper->type)) == 0) return pdFALSE;
+    return Dept_EventExpired(job, xTaskGetTickCount()) ? pdFALSE : pdTRUE; // Stale - left to the owner's TTL sweep
+}
+
+uint32_t MutualAid_Helpers(const EmergencyEvent_t *event)
+{
+    if (event->units > 1) return 0; // Gangs stay with their owner
+
+    uint32_t helpers = 0;
+    for (uint32_t i = 0; i < mutualAidMatrixCount; i++) {
+        const MutualAidCapability_t *c = &mutualAidMatrix[i];
+        if (c->owner == event->type && strncmp(c->detail, event->event_detail, sizeof(event->event_detail)) == 0) {
+            helpers |= 1u << c->helper;
+        }
+    }
+    return helpers;
+}
+
+
+BaseType_t MutualAid_IsHelper(const DepartmentDescription_t *helper)
+{
+    for (uint32_t i = 0; i < mutualAidMatrixCount; i++) {
+        if (mutualAidMatrix[i].helper == helper->type) return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+DepartmentDescription_t *MutualAid_Take(DepartmentDescription_t *helper, DeptJob_t *job,
+                                        uint32_t *deadline, uint8_t *penaltyPct)
+{
+    /* Departments that want aid and have catalog items this helper can serve - most backlogged first */
+    DepartmentDescription_t *candidates[DEPT_REGISTRY_MAX];
+    UBaseType_t backlogs[DEPT_REGISTRY_MAX];
+    UBaseType_t count = 0;
+
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d == NULL || d == helper || !d->aidWanted) continue;
+        if (FindCapability(d->type, NULL, helper->type) == NULL) continue;
+
+        const UBaseType_t backlog = Dept_Backlog(d);
+        if (backlog == 0) continue;
+
+        UBaseType_t pos = count++;
+        for (; pos > 0 && backlogs[pos - 1] < backlog; pos--) { // Insertion sort - a handful of departments
+            candidates[pos] = candidates[pos - 1];
+            backlogs[pos] = backlogs[pos - 1];
+        }
+        candidates[pos] = d;
+        backlogs[pos] = backlog;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        DepartmentDescription_t *owner = candidates[i];
+        if (Dept_TakeIf(owner, HelperCanServe, helper, job, deadline) != pdPASS) {
+            continue; // Only items the helper cannot serve - try the next department
+        }
+
+        Dept_SignalManager(owner, DEPT_SIG_BACKLOG); // Owner backlog shrank - it may release the aid request
+
+        *penaltyPct = FindCapability(job->event.type, job->event.event_detail, helper->type)->penaltyPct;
+        taskENTER_CRITICAL(); // Helper vehicles of several departments count concurrently
+        owner->aidReceived++;
+        helper->aidGiven++;
+        taskEXIT_CRITICAL();
+
+        return owner;
+    }
+
+    return NULL;
+}
+
+void MutualAid_UpdateRequest(DepartmentDescription_t *d, UBaseType_t backlog, TickType_t *saturatedSince)
+{
+    const TickType_t now = xTaskGetTickCount();
+
+    /* Saturated = events are waiting and no vehicle of the department is free */
+    if (backlog > 0 && uxSemaphoreGetCount(d->availableSem) == 0) {
+        if (*saturatedSince == 0) *saturatedSince = now ? now : 1;
+    } else {
+        *saturatedSince = 0;
+    }
+
+    const BaseType_t wanted = (backlog >= MUTUAL_AID_BACKLOG) ||
+                              (*saturatedSince != 0 && (now - *saturatedSince) >= pdMS_TO_TICKS(MUTUAL_AID_WAIT_MS));
+
+    if (wanted != d->aidWanted) {
+        d->aidWanted = wanted;
+        printf("[Client][%s] Dept=%s -> mutual aid %s (backlog=%u received=%u given=%u)\n",
+               pcTaskGetName(NULL), d->name, wanted ? "REQUESTED" : "released",
+               (unsigned)backlog, (unsigned)d->aidReceived, (unsigned)d->aidGiven);
+    }
+}
@@ -1,29 +1,21 @@
 /**
  * @file Vehicle_Task.c
- * @brief This file contains the implementation of each department vehicle tasks that simulate communication between vehicles and the dispatcher.
+ * @brief This file contains the implementation of the department vehicle task that simulate communication between vehicles and the dispatcher.
+ *        One generic task serves every department - the vehicle state (VehicleState_t) is passed as task parameter.
  * 
  * @attention Task_TestVehicle is for testing purposes only - and will not be created in the final system.
  */
 
 #include "Client/Vehicle_Task.h"
+#include "Client/Client_UDP.h"
+#include "Client/MutualAid.h"
+#include "Client/Location.h"
+#include "Client/FleetStats.h"
+#include "Client/Coalesce.h"
 #include "Shared_Configuration.h"
 
 #include <stdio.h>
 
-// Helper function to map EventType_t to corresponding department counting semaphore handle
-static SemaphoreHandle_t DeptSemFromType(EventType_t type)
-{
-    switch (type) {
-        case EVENT_AMBULANCE:        return handleSem_deptAmbulance;
-        case EVENT_POLICE:           return handleSem_deptPolice;
-        case EVENT_FIRE_DEPARTMENT:  return handleSem_deptFire;
-        case EVENT_MAINTENANCE:      return handleSem_deptMaint;
-        case EVENT_WASTE_COLLECTION: return handleSem_deptWaste;
-        case EVENT_ELECTRICITY:      return handleSem_deptElect;
-        default:                     return NULL;
-    }
-}
-
 
 
 void Task_TestVehicle(void *pvParameters)
@@ -34,31 +26,20 @@ void Task_TestVehicle(void *pvParameters)
 
     /* Main loop for Vehicle -> Dispatcher communication */
     for (;;) {
-        EmergencyEvent_t event;
+        DeptJob_t job;
 
         /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptAmbulanceQ, &event, portMAX_DELAY) == pdPASS) { // Using Ambulance queue for testing
+        if (xPQueueReceive(g_depts[EVENT_AMBULANCE].queue, &job, NULL, portMAX_DELAY) == pdPASS) { // Using Ambulance queue for testing
+            const EmergencyEvent_t event = job.event;
             printf("[Client][VEHICLE] Handling event id=%u type=%d priority=%d\n",
                    (unsigned)event.eventID, (int)event.type, (int)event.priority);
 
             /* Simulate handling the event - Very long delay */
             vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "Vehicle");
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][VEHICLE] Drop completion message id=%u (TX queue full)\n", (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][VEHICLE] Sent completion message id=%u\n", (unsigned)Msg.eventID);
-            }
+            /* Append completion message to the Client completion journal */
+            ClientUDP_JournalCompletion(event.eventID, "Vehicle", STATUS_SUCCESS);
+            printf("[Client][VEHICLE] Journaled completion message id=%u\n", (unsigned)event.eventID);
 
             printf("[Client][VEHICLE] Completed event id=%u\n", (unsigned)event.eventID);
         }
@@ -67,428 +48,1149 @@ void Task_TestVehicle(void *pvParameters)
     vTaskDelete(NULL); // Should never reach here
 }
 
-void Task_Ambulance_X(void *pvParameters)
+/**
+ * @brief Finds the idle vehicle of a department that is nearest to a location (lowest index on ties).
+ * @param d - Department
+ * @param location - Location index of the event
+ * 
+ * @attention This function is static and only used within this file.
+ * @return VehicleState_t* Nearest idle vehicle, or NULL if no vehicle is idle.
+ */
+static VehicleState_t *NearestIdleVehicle(DepartmentDescription_t *d, uint8_t location)
 {
-    (void)pvParameters;
-
-    printf("[Client][%s] Started\n",pcTaskGetName(NULL));
+    VehicleState_t *nearest = NULL;
+    uint32_t nearestMs = UINT32_MAX;
 
-    /* Main loop for Ambulance -> Dispatcher communication */
-    for (;;) {
-        EmergencyEvent_t event;
+    for (UBaseType_t i = 0; i < d->vehicles; i++) {
+        VehicleState_t *v = &d->fleet[i];
+        if (!v->idle) continue;
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
-        }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
-            continue;
+        const uint32_t ms = Location_TravelMs(v->position, location);
+        if (ms < nearestMs) {
+            nearest = v;
+            nearestMs = ms;
         }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
+    }
+    return nearest;
+}
 
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptAmbulanceQ, &event, portMAX_DELAY) == pdPASS) { // Using Ambulance queue for testing
+/**
+ * @brief Claim-with-grace (pull mode) - notifies the idle vehicle nearest to the new head event of the department,
+ *        which may be waiting out the grace period of an event that was just taken.
+ * @param d - Department
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void VehicleClaimNext(DepartmentDescription_t *d)
+{
+    DeptJob_t head;
+    if (xPQueuePeek(d->queue, &head, NULL, 0) != pdPASS) return;
 
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptAmbulance
+    VehicleState_t *nearest = NearestIdleVehicle(d, Location_Parse(head.event.location));
+    if (nearest != NULL) (void)xTaskNotifyGiveIndexed(nearest->task, VEHICLE_CLAIM_INDEX);
+}
 
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
-                continue;
-            }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
-            
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority);
+/**
+ * @brief Start position of a vehicle - fleets start spread over the streets, offset per department.
+ * @attention This function is static and only used within this file.
+ */
+static uint8_t VehicleStartPosition(const DepartmentDescription_t *d, UBaseType_t index)
+{
+    return (uint8_t)((d->type * 7u + index * LOCATION_COUNT / d->vehicles) % LOCATION_COUNT);
+}
 
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
+/**
+ * @brief On-site handling time of a job that is still to do.
+ * @param job - Job to handle
+ * @param penaltyPct - Extra handling time in percent (mutual aid for another department), 0 for own events
+ * 
+ * @attention This function is static and only used within this file.
+ * @return uint32_t Handling time in ms (without travel) - the remaining time of a preempted job.
+ */
+static uint32_t VehicleHandlingMs(const DeptJob_t *job, uint8_t penaltyPct)
+{
+    if (job->remainingMs != 0) return job->remainingMs; // Preempted job - penalty already included
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
+    const uint32_t handlingMs = baseEventHandling_Delay_MS * job->event.delayFactor;
+    return handlingMs + handlingMs * penaltyPct / 100u;
+}
+
+/**
+ * @brief Journals the completion message of a handled (or dropped) event and closes its incident (see Coalesce.h).
+ * @param who - Name of the vehicle that handled it
+ * @param event - Handled event
+ * @param status - STATUS_SUCCESS, STATUS_FAILED for a preempted job that found no room in its backlog,
+ *                 or STATUS_EXPIRED for an event dequeued past its TTL
+ * 
+ * @attention Never blocks (Vehicle_Handoff() may run in a dispatcher or manager).
+ *            This function is static and only used within this file.
+ */
+static void VehicleJournalCompletion(const char *who, const EmergencyEvent_t *event, uint8_t status)
+{
+#if COALESCE_ENABLE
+    Coalesce_Close(event); // Later reports of the incident are new incidents
+#endif
 
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
+    ClientUDP_JournalCompletion(event->eventID, who, status);
+    printf("[Client][%s] Journaled completion message id=%u\n", who, (unsigned)event->eventID);
 
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
+    printf("[Client][%s] %s event id=%u\n", who,
+           (status == STATUS_SUCCESS) ? "Completed" : (status == STATUS_EXPIRED) ? "EXPIRED" : "FAILED", (unsigned)event->eventID);
+}
+
+/* Gang reservation of a vehicle - context of the FitsReservation predicate */
+typedef struct {
+    const DepartmentDescription_t *dept;
+    UBaseType_t units; // Vehicle tokens reserved
+} GangFit_t;
+
+/**
+ * @brief xPQueueReceiveIf predicate - pdTRUE if the reservation (context) covers the vehicles the event needs.
+ *        The head may change between peek and receive, so the most urgent event the reservation covers is taken.
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t FitsReservation(const void *pvItem, void *pvContext)
+{
+    const GangFit_t *fit = (const GangFit_t *)pvContext;
+    return (Dept_EventUnits(fit->dept, &((const DeptJob_t *)pvItem)->event) <= fit->units) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief Takes the most urgent job a reservation covers and gives back the tokens it does not need.
+ * @param d - Department
+ * @param reserved - Tokens taken with Dept_Reserve() for the peeked head job
+ * @param job - Output job
+ * @param key - Output queue key (deadline tick)
+ * 
+ * @attention This function is static and only used within this file.
+ * @return UBaseType_t Tokens kept for the job (its gang size), 0 if nothing was taken (all tokens given back).
+ */
+static UBaseType_t VehicleTakeReserved(DepartmentDescription_t *d, UBaseType_t reserved,
+                                       DeptJob_t *job, uint32_t *key)
+{
+    const EmergencyEvent_t *event = &job->event;
+    GangFit_t fit = { d, reserved };
+
+    for (;;) {
+        /* Scan of at most DEPT_Q_LEN items - the head fits unless another vehicle took it meanwhile */
+        if (xPQueueReceiveIf(d->queue, job, key, FitsReservation, &fit) != pdPASS) {
+            Dept_Release(d, reserved);
+            return 0;
         }
-        
+        Dept_Refill(d); // Free slot in the queue - pull the most urgent spilled event back in
+
+        if (!Dept_EventExpired(job, xTaskGetTickCount())) break;
+
+        /* Waited past its TTL - drop it before it takes a vehicle, the reservation covers the next one */
+        taskENTER_CRITICAL(); // Metric - shared with the manager sweep (Dept_TakeExpired)
+        d->expired++;
+        taskEXIT_CRITICAL();
+        VehicleJournalCompletion(pcTaskGetName(NULL), event, STATUS_EXPIRED);
     }
 
-    vTaskDelete(NULL); // Should never reach here
+    const UBaseType_t units = Dept_EventUnits(d, event);
+    Dept_Release(d, reserved - units); // The head changed to a smaller incident
+
+    if (units > 1) {
+        printf("[Client][%s] GANG Dept=%s event id=%u '%s' -> %u vehicles\n",
+               pcTaskGetName(NULL), d->name, (unsigned)event->eventID, event->event_detail, (unsigned)units);
+    }
+    return units;
 }
 
-void Task_Police_X(void *pvParameters)
+#if PREEMPT_ENABLE
+/**
+ * @brief xPQueueReceiveIf predicate - pdTRUE for events that may preempt (priority >= PREEMPT_PRIORITY_MIN, not past
+ *        their TTL) and need a single vehicle of the department (context) - a gang is never assembled by preemption.
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t IsCritical(const void *pvItem, void *pvContext)
 {
-    (void)pvParameters;
+    const DeptJob_t *job = (const DeptJob_t *)pvItem;
+    const EmergencyEvent_t *event = &job->event;
+    return (event->priority >= PREEMPT_PRIORITY_MIN && !Dept_EventExpired(job, xTaskGetTickCount()) &&
+            Dept_EventUnits((const DepartmentDescription_t *)pvContext, event) == 1) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief Preempted job - puts it back into its backlog with its original deadline, so the next free vehicle resumes it.
+ * @param who - Name of the preempted vehicle
+ * @param owner - Department the job belongs to
+ * @param job - Job, remainingMs set to the handling time left
+ * @param key - Original queue key (deadline tick)
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void VehicleRequeue(const char *who, DepartmentDescription_t *owner, const DeptJob_t *job, uint32_t key)
+{
+    EmergencyEvent_t rejected;
 
-    printf("[Client][%s] Started\n", pcTaskGetName(NULL));
+    if (Dept_Requeue(owner, job, key, &rejected) != pdPASS) {
+        VehicleJournalCompletion(who, &rejected, STATUS_FAILED); // Backlog at its spill cap
+    }
+    Dept_SignalManager(owner, DEPT_SIG_BACKLOG);
+#if VEHICLE_HANDOFF
+    (void)Vehicle_Handoff(owner); // An idle vehicle of the owner may resume it right away
+#endif
+}
+#endif
+
+/**
+ * @brief Simulated delay that ends early when the vehicle is preempted (Vehicle_Preempt() aborts the delay).
+ * @param self - This vehicle
+ * @param ms - Delay
+ * 
+ * @attention This function is static and only used within this file.
+ * @return uint32_t 0 if the whole delay passed, else the ms that were left.
+ */
+static uint32_t VehicleDelay(VehicleState_t *self, uint32_t ms)
+{
+    const TickType_t end = xTaskGetTickCount() + pdMS_TO_TICKS(ms);
 
-    /* Main loop for Police -> Dispatcher communication */
     for (;;) {
-        EmergencyEvent_t event;
+        const TickType_t left = end - xTaskGetTickCount();
+        if ((int32_t)left <= 0) return 0;
+        if (self->preempt) return (uint32_t)(left * portTICK_PERIOD_MS);
+        vTaskDelay(left); // xTaskAbortDelay() ends it early
+    }
+}
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
-        }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
-            continue;
-        }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
+/**
+ * @brief Ends the preemptible part of a job.
+ * @param self - This vehicle
+ * 
+ * @attention This function is static and only used within this file.
+ * @return BaseType_t pdTRUE if Vehicle_Preempt() asked for the vehicle meanwhile.
+ */
+static BaseType_t VehicleJobEnd(VehicleState_t *self)
+{
+    taskENTER_CRITICAL();
+    const BaseType_t preempted = self->preempt;
+    self->preempt = pdFALSE;
+    self->jobPriority = 0;
+    taskEXIT_CRITICAL();
 
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptPoliceQ, &event, portMAX_DELAY) == pdPASS) {
-            
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptPolice
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
-                continue;
-            }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
-            
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority); 
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
+    return preempted;
+}
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
+/**
+ * @brief Simulates handling of one job (travel to the scene + on-site handling) and journals its completion message.
+ *        If the vehicle is preempted, the job goes back to its backlog and the vehicle handles a critical event instead.
+ *        Own jobs that run in one piece feed the service time estimate (Dept_OnServiceEnd) - the timing restarts with
+ *        the critical event, and neither the preempted part nor a resumed remainder is a sample.
+ * @param self - Vehicle handling the job - ends up at the event location
+ * @param owner - Department the job belongs to (another one for mutual aid)
+ * @param job - Job to handle - replaced by the critical event on preemption
+ * @param key - Queue key (deadline tick) of the job
+ * @param penaltyPct - Extra handling time in percent (mutual aid for another department), 0 for own events
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void VehicleHandleEvent(VehicleState_t *self, DepartmentDescription_t *owner, DeptJob_t *job,
+                               uint32_t key, uint8_t penaltyPct)
+{
+    const EmergencyEvent_t *event = &job->event;
+
+    for (;;) {
+        const uint8_t  scene      = Location_Parse(event->location);
+        const uint32_t travelMs   = Location_TravelMs(self->position, scene);
+        const uint32_t handlingMs = VehicleHandlingMs(job, penaltyPct);
+        const BaseType_t sample   = (owner == self->dept && job->remainingMs == 0); // Own job from its start - load estimate
+        const TickType_t serviceStart = xTaskGetTickCount();
+
+        printf("[Client][%s] Handling event id=%u type=%d priority=%d (travel=%ums from Street %u%s)\n",
+               pcTaskGetName(NULL), (unsigned)event->eventID, (int)event->type, (int)event->priority,
+               (unsigned)travelMs, (unsigned)self->position, job->remainingMs ? ", resumed" : "");
 
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
+        if (self->units == 1) self->jobPriority = event->priority; // Preemption candidate from now on - a gang keeps its vehicles
 
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
+        /* Simulate travel to the scene */
+        uint32_t leftMs = VehicleDelay(self, travelMs);
+        if (leftMs == 0) {
+            if (scene != LOCATION_UNKNOWN) self->position = scene;
+
+            /* Simulate handling the event - Very long delay */
+            leftMs = VehicleDelay(self, handlingMs); // Simulated handling time
+        } else {
+            leftMs = handlingMs; // Preempted on the way - all of the handling is still to do
         }
 
+        if (!VehicleJobEnd(self) || leftMs == 0) { // Done (a late preemption finds this vehicle free anyway)
+            if (sample) Dept_OnServiceEnd(owner, (uint32_t)((xTaskGetTickCount() - serviceStart) * portTICK_PERIOD_MS));
+            break;
+        }
+
+#if PREEMPT_ENABLE
+        /* Preempted - take the most urgent critical event of our department, unless another vehicle was faster */
+        DeptJob_t critical;
+        uint32_t criticalKey;
+        job->remainingMs = leftMs;
+        if (xPQueueReceiveIf(self->dept->queue, &critical, &criticalKey, IsCritical, self->dept) != pdPASS) {
+            continue; // Resume the job
+        }
+        Dept_Refill(self->dept);
+
+        printf("[Client][%s] PREEMPTED job id=%u prio=%u (%ums left) -> critical id=%u\n",
+               pcTaskGetName(NULL), (unsigned)event->eventID, (unsigned)event->priority,
+               (unsigned)leftMs, (unsigned)critical.event.eventID);
+        VehicleRequeue(pcTaskGetName(NULL), owner, job, key);
+
+        *job       = critical;
+        key        = criticalKey;
+        owner      = self->dept;
+        penaltyPct = 0;
+        Dept_OnServiceStart(owner, job, key);
+        Dept_SignalManager(owner, DEPT_SIG_VEHICLE);
+#endif
     }
 
-    vTaskDelete(NULL); // Should never reach here
+    VehicleJournalCompletion(pcTaskGetName(NULL), event, STATUS_SUCCESS);
 }
 
-void Task_Fire_X(void *pvParameters)
+#if MUTUAL_AID_ENABLE
+/**
+ * @brief Idle vehicle - serves one event of a department that asked for mutual aid, if there is eligible work.
+ * @param self - This vehicle
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void VehicleServeMutualAid(VehicleState_t *self)
 {
-    (void)pvParameters;
+    DepartmentDescription_t *d = self->dept;
 
-    printf("[Client][%s] Started\n", pcTaskGetName(NULL));
+    if (self->retire) return; // Retired by the autoscaler - park instead
+    if (Dept_Backlog(d) > 0) return; // Own events wait (a gang head collecting its vehicles) - do not lend any away
 
-    /* Main loop for Fire Department -> Dispatcher communication */
-    for (;;) {
-        EmergencyEvent_t event;
+    if (Dept_Reserve(d, 1, 0) != pdPASS) {
+        return; // No free vehicle token (busy, on break, or collected by a gang reservation)
+    }
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
+    DeptJob_t job;
+    uint32_t deadline = 0;
+    uint8_t penaltyPct = 0;
+    DepartmentDescription_t *owner = MutualAid_Take(d, &job, &deadline, &penaltyPct);
+
+    if (owner == NULL) {
+        Dept_Release(d, 1); // Nothing to help with - release the token silently
+        return;
+    }
+
+    self->idle = pdFALSE;
+    self->units = 1; // Aid is lent one vehicle at a time
+    FleetStats_SetActivity(self, VEHICLE_BUSY);
+    Dept_OnServiceStart(owner, &job, deadline);
+    Dept_SignalManager(d, DEPT_SIG_VEHICLE); // One token less for our own backlog
+    printf("[Client][%s] MUTUAL AID for Dept=%s event id=%u ('%s' penalty=%u%%)\n",
+           pcTaskGetName(NULL), owner->name, (unsigned)job.event.eventID, job.event.event_detail, (unsigned)penaltyPct);
+    VehicleHandleEvent(self, owner, &job, deadline, penaltyPct);
+    self->idle = pdTRUE;
+    FleetStats_SetActivity(self, VEHICLE_IDLE);
+
+    Dept_Release(d, self->units); // Release vehicle resource back
+    Dept_SignalManager(d, DEPT_SIG_VEHICLE);
+}
+#endif
+
+/**
+ * @brief Parks a vehicle task the autoscaler retired (Vehicle_Retire) until Vehicle_Activate() clears its flag.
+ *        Returns right away for an active vehicle.
+ * @param self - This vehicle, free (no job, no vehicle token, not on the idle stack)
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void VehiclePark(VehicleState_t *self)
+{
+    taskENTER_CRITICAL();
+    if (self->retire) self->parked = pdTRUE;
+    const BaseType_t parked = self->parked; // Also set by Vehicle_Retire() when it took us off the idle stack
+    taskEXIT_CRITICAL();
+
+    if (!parked) return;
+
+    self->idle = pdFALSE;
+    if (self->retire) {
+        FleetStats_SetActivity(self, VEHICLE_RETIRED);
+        printf("[Client][%s] RETIRED - parked until the fleet grows\n", pcTaskGetName(NULL));
+        while (self->retire) {
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Vehicle_Activate() clears the flag, then notifies
         }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
-            continue;
+        FleetStats_SetActivity(self, VEHICLE_IDLE);
+        printf("[Client][%s] Back in service (dept=%s position=Street %u)\n",
+               pcTaskGetName(NULL), self->dept->name, (unsigned)self->position);
+    }
+    self->parked = pdFALSE;
+    self->idle = pdTRUE;
+}
+
+#if VEHICLE_HANDOFF
+/**
+ * @brief Parks a vehicle on the idle stack of its department.
+ * @param v - Vehicle
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void IdlePush(VehicleState_t *v)
+{
+    DepartmentDescription_t *d = v->dept;
+
+    taskENTER_CRITICAL();
+    d->idleStack[d->idleCount++] = v;
+    v->idle = pdTRUE;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Takes a vehicle off the idle stack at a given position, keeping the order of the others.
+ * @attention This function is static and only used within this file, must be called inside a critical section.
+ */
+static VehicleState_t *IdleTakeAt(DepartmentDescription_t *d, UBaseType_t pos)
+{
+    VehicleState_t *v = d->idleStack[pos];
+    for (UBaseType_t i = pos + 1; i < d->idleCount; i++) d->idleStack[i - 1] = d->idleStack[i];
+    d->idleCount--;
+    v->idle = pdFALSE;
+    return v;
+}
+
+/**
+ * @brief Takes a vehicle off the idle stack (before it does other work).
+ * @param v - Vehicle
+ * 
+ * @attention This function is static and only used within this file.
+ * @return BaseType_t pdTRUE if removed, pdFALSE if it was already popped by Vehicle_Handoff() (its mail is on the way).
+ */
+static BaseType_t IdleRemove(VehicleState_t *v)
+{
+    DepartmentDescription_t *d = v->dept;
+    BaseType_t removed = pdFALSE;
+
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < d->idleCount; i++) {
+        if (d->idleStack[i] == v) {
+            (void)IdleTakeAt(d, i);
+            removed = pdTRUE;
+            break;
         }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
+    }
+    taskEXIT_CRITICAL();
 
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptFireQ, &event, portMAX_DELAY) == pdPASS) {
-            
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptFire
+    return removed;
+}
 
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
-                continue;
+/**
+ * @brief Pops the idle vehicle nearest to a location (most recently idle on ties).
+ * @param d - Department
+ * @param location - Location index of the event
+ * 
+ * @attention This function is static and only used within this file.
+ * @return VehicleState_t* Vehicle, or NULL if no vehicle is idle.
+ */
+static VehicleState_t *IdlePopNearest(DepartmentDescription_t *d, uint8_t location)
+{
+    VehicleState_t *v = NULL;
+
+    taskENTER_CRITICAL();
+    if (d->idleCount > 0) {
+        UBaseType_t best = d->idleCount - 1; // Top of the stack
+        uint32_t bestMs = Location_TravelMs(d->idleStack[best]->position, location);
+
+        for (UBaseType_t i = best; i-- > 0; ) {
+            const uint32_t ms = Location_TravelMs(d->idleStack[i]->position, location);
+            if (ms < bestMs) {
+                best = i;
+                bestMs = ms;
             }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
+        }
+        v = IdleTakeAt(d, best);
+    }
+    taskEXIT_CRITICAL();
 
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority); 
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
+    return v;
+}
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
+#if SERVICE_CLOCK
+/* Pending service completion - entry of the service clock min-heap */
+typedef struct {
+    TickType_t due;         // Tick the service ends
+    VehicleState_t *v;
+} ServiceClockEntry_t;
 
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
+static ServiceClockEntry_t *clockHeap;     // Min-heap by due tick - one entry per busy vehicle
+static UBaseType_t          clockCount;
+static UBaseType_t          clockCapacity; // Total vehicles of all departments
+static TaskHandle_t         clockTask;     // Task_ServiceClock - notified on a new earliest completion
 
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
-        }
+/**
+ * @brief Name of a vehicle record - same as the vehicle task names ("<DEPT>_<n>").
+ * @attention This function is static and only used within this file.
+ */
+static void VehicleName(const VehicleState_t *v, char *name, size_t len)
+{
+    snprintf(name, len, "%s_%u", v->dept->name, (unsigned)(v->index + 1));
+}
 
+/**
+ * @brief pdTRUE if tick a is before tick b (wrap-safe).
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t ClockBefore(TickType_t a, TickType_t b)
+{
+    return ((int32_t)(a - b) < 0) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief Puts an entry at a heap position and records the position in its vehicle.
+ * @attention This function is static and only used within this file, must be called inside a critical section.
+ */
+static void ClockPlace(UBaseType_t pos, ServiceClockEntry_t e)
+{
+    clockHeap[pos] = e;
+    e.v->clockPos = pos;
+}
+
+/**
+ * @brief Moves an entry from a free heap position towards the root until the heap order holds.
+ * @attention This function is static and only used within this file, must be called inside a critical section.
+ * @return UBaseType_t Final position of the entry.
+ */
+static UBaseType_t ClockSiftUp(UBaseType_t pos, ServiceClockEntry_t e)
+{
+    while (pos > 0 && ClockBefore(e.due, clockHeap[(pos - 1) / 2].due)) {
+        ClockPlace(pos, clockHeap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
     }
+    ClockPlace(pos, e);
+    return pos;
+}
 
-    vTaskDelete(NULL); // Should never reach here
+/**
+ * @brief Moves an entry from a free heap position towards the leaves until the heap order holds.
+ * @attention This function is static and only used within this file, must be called inside a critical section.
+ */
+static void ClockSiftDown(UBaseType_t pos, ServiceClockEntry_t e)
+{
+    for (;;) {
+        UBaseType_t child = 2 * pos + 1;
+        if (child >= clockCount) break;
+        if (child + 1 < clockCount && ClockBefore(clockHeap[child + 1].due, clockHeap[child].due)) child++;
+        if (!ClockBefore(clockHeap[child].due, e.due)) break;
+        ClockPlace(pos, clockHeap[child]);
+        pos = child;
+    }
+    ClockPlace(pos, e);
 }
 
-void Task_Maintenance_X(void *pvParameters)
+/**
+ * @brief Removes the entry at a heap position (the root for completions, any position for preemption).
+ * @attention This function is static and only used within this file, must be called inside a critical section.
+ */
+static void ClockRemoveAt(UBaseType_t pos)
 {
-    (void)pvParameters;
+    const ServiceClockEntry_t last = clockHeap[--clockCount];
+    if (pos == clockCount) return; // Removed the last entry itself
 
-    printf("[Client][%s] Started\n", pcTaskGetName(NULL));
+    if (pos > 0 && ClockBefore(last.due, clockHeap[(pos - 1) / 2].due)) {
+        (void)ClockSiftUp(pos, last);
+    } else {
+        ClockSiftDown(pos, last);
+    }
+}
 
-    /* Main loop for Maintenance -> Dispatcher communication */
-    for (;;) {
-        EmergencyEvent_t event;
+/**
+ * @brief Schedules the completion of a vehicle record - from then on it is a preemption candidate.
+ * @param v - Vehicle record, its job in v->mail
+ * @param due - Tick the service ends
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void ServiceClockSchedule(VehicleState_t *v, TickType_t due)
+{
+    /* A busy vehicle has exactly one entry, so the heap never outgrows the fleet */
+    taskENTER_CRITICAL();
+    configASSERT(clockCount < clockCapacity);
+    const UBaseType_t pos = ClockSiftUp(clockCount++, (ServiceClockEntry_t){ due, v });
+    if (v->units == 1) v->jobPriority = v->mail.event.priority; // A gang keeps its vehicles
+    taskEXIT_CRITICAL();
+
+    if (pos == 0) (void)xTaskNotifyGive(clockTask); // New earliest completion - the clock sleeps too long otherwise
+}
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
-        }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
-            continue;
-        }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
+/**
+ * @brief Starts the service of the event in a vehicle record's mailbox and schedules its completion.
+ * @param v - Vehicle record, already taken off the idle stack, holding a token of its department
+ * @param owner - Department the event belongs to (another one for mutual aid)
+ * @param penaltyPct - Extra handling time in percent (mutual aid), 0 for own events
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void ServiceClockStart(VehicleState_t *v, DepartmentDescription_t *owner, uint8_t penaltyPct)
+{
+    const EmergencyEvent_t *event = &v->mail.event;
+    const uint8_t  scene      = Location_Parse(event->location);
+    const uint32_t travelMs   = Location_TravelMs(v->position, scene);
+    const uint32_t handlingMs = VehicleHandlingMs(&v->mail, penaltyPct);
+    char name[32];
+    VehicleName(v, name, sizeof(name));
+
+    FleetStats_SetActivity(v, VEHICLE_BUSY);
+    Dept_OnServiceStart(owner, &v->mail, v->mailKey);
+    Dept_SignalManager(v->dept, DEPT_SIG_VEHICLE); // Token taken - saturation / aid may change
+
+    printf("[Client][%s] Handling event id=%u type=%d priority=%d (travel=%ums from Street %u%s)\n",
+           name, (unsigned)event->eventID, (int)event->type, (int)event->priority,
+           (unsigned)travelMs, (unsigned)v->position, v->mail.remainingMs ? ", resumed" : "");
+
+    v->servingFor   = owner;
+    v->scene        = scene;
+    v->handlingMs   = handlingMs;
+    v->serviceStart = xTaskGetTickCount(); // Restarts with the critical event of a preemption
+    ServiceClockSchedule(v, v->serviceStart + pdMS_TO_TICKS(travelMs + handlingMs));
+}
 
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptMaintQ, &event, portMAX_DELAY) == pdPASS) {
-            
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptMaint
+/**
+ * @brief Pops the earliest completion if it is due.
+ * @param now - Current tick
+ * @param wait - Output: ticks until the earliest completion if none is due (portMAX_DELAY = no vehicle busy)
+ * 
+ * @attention This function is static and only used within this file.
+ * @return VehicleState_t* Vehicle whose service ended, or NULL if none is due.
+ */
+static VehicleState_t *ServiceClockPopDue(TickType_t now, TickType_t *wait)
+{
+    VehicleState_t *v = NULL;
 
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
-                continue;
-            }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
+    taskENTER_CRITICAL();
+    if (clockCount == 0) {
+        *wait = portMAX_DELAY;
+    }
+    else if (ClockBefore(now, clockHeap[0].due)) {
+        *wait = clockHeap[0].due - now;
+    }
+    else {
+        v = clockHeap[0].v;
+        v->jobPriority = 0; // Done - no longer a preemption candidate
+        ClockRemoveAt(0);
+    }
+    taskEXIT_CRITICAL();
 
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority);
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
+    return v;
+}
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
+#if PREEMPT_ENABLE
+/**
+ * @brief Preempted vehicle record - its job goes back to the backlog and it takes a critical event of its department.
+ * @param v - Vehicle record, already removed from the heap by Vehicle_Preempt()
+ * @param due - Tick its job would have ended
+ * @param now - Current tick
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void ServiceClockPreempt(VehicleState_t *v, TickType_t due, TickType_t now)
+{
+    DepartmentDescription_t *d = v->dept;
+    DeptJob_t critical;
+    uint32_t criticalKey;
+    char name[32];
+    VehicleName(v, name, sizeof(name));
+
+    if (xPQueueReceiveIf(d->queue, &critical, &criticalKey, IsCritical, d) != pdPASS) {
+        ServiceClockSchedule(v, due); // Critical event already taken - keep the job
+        return;
+    }
+    Dept_Refill(d);
+
+    /* Handling time left - all of it while the vehicle is still on the way to the scene */
+    const uint32_t leftMs = (uint32_t)((due - now) * portTICK_PERIOD_MS);
+    if (leftMs < v->handlingMs) {
+        if (v->scene != LOCATION_UNKNOWN) v->position = v->scene;
+        v->mail.remainingMs = leftMs;
+    } else {
+        v->mail.remainingMs = v->handlingMs;
+    }
 
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
+    printf("[Client][%s] PREEMPTED job id=%u prio=%u (%ums left) -> critical id=%u\n",
+           name, (unsigned)v->mail.event.eventID, (unsigned)v->mail.event.priority,
+           (unsigned)v->mail.remainingMs, (unsigned)critical.event.eventID);
+    VehicleRequeue(name, v->servingFor, &v->mail, v->mailKey);
 
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
-        }
+    v->mail    = critical;
+    v->mailKey = criticalKey;
+    ServiceClockStart(v, d, 0);
+}
+#endif
 
+/**
+ * @brief Ends the service of a vehicle record - journals the completion, frees the vehicle and hands it new work.
+ * @param v - Vehicle whose service time has passed
+ * 
+ * @attention The clock runs every vehicle, so it never waits for the TX task - the journal append is lossless
+ *            without blocking (ClientUDP_PostCompletion). This function is static and only used within this file.
+ */
+static void ServiceClockComplete(VehicleState_t *v)
+{
+    DepartmentDescription_t *d = v->dept;
+    char name[32];
+    VehicleName(v, name, sizeof(name));
+
+    if (v->scene != LOCATION_UNKNOWN) v->position = v->scene;
+    VehicleJournalCompletion(name, &v->mail.event, STATUS_SUCCESS); // A burst past the journal ring spills, never drops
+
+    if (v->servingFor == d && v->mail.remainingMs == 0) { // Load estimate (own jobs that ran in one piece only)
+        Dept_OnServiceEnd(d, (uint32_t)((xTaskGetTickCount() - v->serviceStart) * portTICK_PERIOD_MS));
     }
 
-    vTaskDelete(NULL); // Should never reach here
+    /* Idle before the token is released - whoever takes the token always finds an idle vehicle */
+    FleetStats_SetActivity(v, VEHICLE_IDLE);
+    taskENTER_CRITICAL();
+    const BaseType_t retired = v->retire;
+    if (retired) v->parked = pdTRUE; // Retired by the autoscaler while busy - its token is gone already
+    else IdlePush(v);
+    taskEXIT_CRITICAL();
+    if (retired) {
+        FleetStats_SetActivity(v, VEHICLE_RETIRED);
+        printf("[Client][%s] RETIRED - parked until the fleet grows\n", name);
+    }
+    Dept_Release(d, v->units); // Release vehicle resources back (the whole gang)
+    Dept_SignalManager(d, DEPT_SIG_VEHICLE); // Vehicle free again - break policy may use it
+
+    (void)Vehicle_Handoff(d); // Work may be waiting already
 }
 
-void Task_Waste_X(void *pvParameters)
+#if MUTUAL_AID_ENABLE
+/**
+ * @brief Idle vehicle records of a helper department serve events of departments that asked for mutual aid.
+ * @param d - Helper department
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void ServiceClockMutualAid(DepartmentDescription_t *d)
+{
+    /* Own events first - a waiting gang head collects every vehicle that frees up, none is lent away meanwhile */
+    while (d->idleCount > 0 && Dept_Backlog(d) == 0 && Dept_Reserve(d, 1, 0) == pdPASS) {
+        DeptJob_t job;
+        uint32_t deadline = 0;
+        uint8_t penaltyPct = 0;
+        DepartmentDescription_t *owner = MutualAid_Take(d, &job, &deadline, &penaltyPct);
+
+        if (owner == NULL) {
+            Dept_Release(d, 1); // Nothing to help with - release the token silently
+            return;
+        }
+
+        /* Holding a token guarantees an idle vehicle (see ServiceClockComplete) */
+        VehicleState_t *v = IdlePopNearest(d, Location_Parse(job.event.location));
+        configASSERT(v != NULL);
+        v->units = 1;
+
+        v->mail    = job;
+        v->mailKey = deadline;
+        printf("[Client][%s] MUTUAL AID for Dept=%s event id=%u ('%s' penalty=%u%%)\n",
+               pcTaskGetName(NULL), owner->name, (unsigned)job.event.eventID, job.event.event_detail, (unsigned)penaltyPct);
+        ServiceClockStart(v, owner, penaltyPct);
+    }
+}
+#endif
+
+void Task_ServiceClock(void *pvParameters)
 {
     (void)pvParameters;
 
-    printf("[Client][%s] Started\n", pcTaskGetName(NULL));
+    clockTask = xTaskGetCurrentTaskHandle();
+
+    clockCapacity = 0;
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d != NULL) clockCapacity += d->maxVehicles; // Spare vehicles of the autoscaler included
+    }
+
+    clockHeap = pvPortMalloc(clockCapacity * sizeof(ServiceClockEntry_t));
+    if (clockHeap == NULL) {
+        printf("[Client][SERVICE_CLOCK] Failed to allocate the completion heap -> deleting task\n");
+        vTaskDelete(NULL);
+    }
+    clockCount = 0;
+
+    /* Every vehicle record starts idle - the heap exists before the first one can be handed an event */
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d == NULL) continue;
+
+        for (UBaseType_t i = 0; i < d->maxVehicles; i++) {
+            d->fleet[i].position = VehicleStartPosition(d, i);
+            if (i < d->vehicles) IdlePush(&d->fleet[i]); // Spares stay parked until Vehicle_Activate()
+        }
+    }
+
+    printf("[Client][%s] Started (max vehicles=%u, no vehicle tasks)\n", pcTaskGetName(NULL), (unsigned)clockCapacity);
+
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d != NULL) (void)Vehicle_Handoff(d); // Events that arrived before the fleet was idle
+    }
+
+#if MUTUAL_AID_ENABLE
+    TickType_t lastAidPoll = xTaskGetTickCount();
+#endif
 
-    /* Main loop for Waste Collection -> Dispatcher communication */
+    /* Main loop - sleep until the earliest completion, or until a new earlier one is scheduled */
     for (;;) {
-        EmergencyEvent_t event;
+        TickType_t wait;
+        VehicleState_t *v;
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
+        while ((v = ServiceClockPopDue(xTaskGetTickCount(), &wait)) != NULL) {
+            ServiceClockComplete(v);
         }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
-            continue;
+
+#if MUTUAL_AID_ENABLE
+        /* Idle helper vehicles look for mutual aid work as often as their tasks would */
+        const TickType_t now = xTaskGetTickCount();
+        if ((now - lastAidPoll) >= pdMS_TO_TICKS(MUTUAL_AID_POLL_MS)) {
+            lastAidPoll = now;
+            for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++) {
+                DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+                if (d != NULL && MutualAid_IsHelper(d)) ServiceClockMutualAid(d);
+            }
+            continue; // Aid may have scheduled completions
         }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
+        const TickType_t aidWait = pdMS_TO_TICKS(MUTUAL_AID_POLL_MS) - (now - lastAidPoll);
+        if (aidWait < wait) wait = aidWait;
+#endif
 
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptWasteQ, &event, portMAX_DELAY) == pdPASS) {
+        (void)ulTaskNotifyTake(pdTRUE, wait);
+    }
+
+    vTaskDelete(NULL); // Should never reach here
+}
+#endif // SERVICE_CLOCK
+
+UBaseType_t Vehicle_Handoff(DepartmentDescription_t *d)
+{
+    UBaseType_t delivered = 0;
+    DeptJob_t head;
+
+    while (d->idleCount > 0 && xPQueuePeek(d->queue, &head, NULL, 0) == pdPASS) {
+        /* Every vehicle the head incident needs, or none - the head waits for its gang, later events wait behind it.
+           The tokens that are free stay held for the head, so single-vehicle takers cannot starve a gang. */
+        const UBaseType_t units = Dept_EventUnits(d, &head.event);
+        if (Dept_ReserveHold(d, units) != pdPASS) {
+            break; // Vehicles busy or on break - a vehicle that frees up (or the manager returning breaks) hands off
+        }
+
+        VehicleState_t *v = IdlePopNearest(d, Location_Parse(head.event.location));
+        if (v == NULL) { // Another caller took the last idle vehicle
+            Dept_Release(d, units);
+            break;
+        }
+
+        /* Another caller may have taken the peeked head meanwhile - then the vehicle gets the next one it covers */
+        v->units = VehicleTakeReserved(d, units, &v->mail, &v->mailKey);
+        if (v->units == 0) {
+#if SERVICE_CLOCK
+            IdlePush(v); // Vehicle record - straight back to the idle stack
+#else
+            /* "No mail" (units == 0) - the vehicle pushes itself back. Pushing it here would strand a vehicle whose
+               mailbox wait timed out right before the pop: it waits for this notification with portMAX_DELAY. */
+            (void)xTaskNotifyGiveIndexed(v->task, VEHICLE_MAILBOX_INDEX);
+#endif
+            break;
+        }
+
+#if SERVICE_CLOCK
+        ServiceClockStart(v, d, 0); // Vehicle record - the service clock completes it
+#else
+        (void)xTaskNotifyGiveIndexed(v->task, VEHICLE_MAILBOX_INDEX); // Wakes exactly this vehicle
+#endif
+        delivered++;
+    }
+
+    if (d->gangHeld > 0 && Dept_Backlog(d) == 0) {
+        (void)Dept_ReserveHold(d, 0); // The head went elsewhere (expired, or taken by another caller) - free its hold
+    }
 
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptWaste
+    return delivered;
+}
+
+#if !SERVICE_CLOCK
+/**
+ * @brief Vehicle main loop in direct handoff mode - sleeps on the mailbox until Vehicle_Handoff() delivers an event.
+ * @param self - This vehicle
+ * @param idleWait - Max idle sleep before looking for mutual aid work (portMAX_DELAY = never)
+ * 
+ * @attention This function is static and only used within this file, never returns.
+ */
+static void VehicleHandoffLoop(VehicleState_t *self, TickType_t idleWait)
+{
+    DepartmentDescription_t *d = self->dept;
 
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
+    for (;;) {
+        VehiclePark(self); // Retired by the autoscaler - wait until the fleet grows again
+        IdlePush(self);
+        (void)Vehicle_Handoff(d); // Work may be waiting already - possibly for this vehicle
+
+        if (ulTaskNotifyTakeIndexed(VEHICLE_MAILBOX_INDEX, pdTRUE, idleWait) == 0) {
+            if (IdleRemove(self)) {
+#if MUTUAL_AID_ENABLE
+                VehicleServeMutualAid(self); // Own department idle - help a saturated one
+#endif
                 continue;
             }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
+            /* Popped by Vehicle_Handoff() (or taken off by Vehicle_Retire()) right before the timeout - the mail is on its way */
+            (void)ulTaskNotifyTakeIndexed(VEHICLE_MAILBOX_INDEX, pdTRUE, portMAX_DELAY);
+        }
 
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority);
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
+        if (self->parked) continue; // Woken by Vehicle_Retire() - no mail, park
+        if (self->units == 0) continue; // Popped by Vehicle_Handoff() but the event was gone - back to the idle stack
 
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
-            }
+        /* Mail delivered - the tokens of the gang (self->units) were taken by Vehicle_Handoff() on our behalf */
+        FleetStats_SetActivity(self, VEHICLE_BUSY);
+        Dept_OnServiceStart(d, &self->mail, self->mailKey);
+        Dept_SignalManager(d, DEPT_SIG_VEHICLE); // Backlog shrank, token taken - saturation / aid may change
+
+        VehicleHandleEvent(self, d, &self->mail, self->mailKey, 0);
+        FleetStats_SetActivity(self, VEHICLE_IDLE);
+
+        Dept_Release(d, self->units); // Release vehicle resources back (the whole gang)
+        Dept_SignalManager(d, DEPT_SIG_VEHICLE); // Vehicle free again - break policy may use it
+    }
+}
+#endif // !SERVICE_CLOCK
+#endif // VEHICLE_HANDOFF
+
+#if PREEMPT_ENABLE
+BaseType_t Vehicle_Preempt(DepartmentDescription_t *d, const EmergencyEvent_t *critical)
+{
+    if (critical->priority < PREEMPT_PRIORITY_MIN) return pdFALSE;
+    if (Dept_EventUnits(d, critical) > 1) return pdFALSE; // A gang waits for whole free vehicles at the reservation gate
+    if (uxSemaphoreGetCount(d->availableSem) > 0 || d->load.onBreak > 0) {
+        return pdFALSE; // A free vehicle, or one the manager recalls from break, takes it
+    }
+
+    const uint8_t scene = Location_Parse(critical->location);
+    VehicleState_t *victim = NULL;
+    uint32_t victimMs = 0;
+#if SERVICE_CLOCK
+    const TickType_t now = xTaskGetTickCount();
+    TickType_t due = 0;
+#endif
+
+    /* Lowest-priority job, nearest to the critical event on ties */
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < d->vehicles; i++) {
+        VehicleState_t *v = &d->fleet[i];
+        if (v->jobPriority == 0 || v->jobPriority >= critical->priority || v->preempt) continue;
+#if SERVICE_CLOCK
+        if (!ClockBefore(now, clockHeap[v->clockPos].due)) continue; // Ends right now - the clock frees it anyway
+#endif
+        const uint32_t ms = Location_TravelMs(v->position, scene);
+        if (victim == NULL || v->jobPriority < victim->jobPriority ||
+            (v->jobPriority == victim->jobPriority && ms < victimMs)) {
+            victim = v;
+            victimMs = ms;
+        }
+    }
+    if (victim != NULL) {
+#if SERVICE_CLOCK
+        due = clockHeap[victim->clockPos].due;
+        ClockRemoveAt(victim->clockPos);
+        victim->jobPriority = 0;
+#else
+        victim->preempt = pdTRUE;
+#endif
+    }
+    taskEXIT_CRITICAL();
+
+    if (victim == NULL) return pdFALSE; // Every vehicle serves a job at least as urgent
+
+#if SERVICE_CLOCK
+    ServiceClockPreempt(victim, due, now);
+#else
+    printf("[Client][%s] PREEMPT Dept=%s %s for critical id=%u\n",
+           pcTaskGetName(NULL), d->name, pcTaskGetName(victim->task), (unsigned)critical->eventID);
+    (void)xTaskAbortDelay(victim->task); // Fails only between delays - the vehicle checks its flag before the next one
+#endif
+    return pdTRUE;
+}
+#endif // PREEMPT_ENABLE
+
+BaseType_t Vehicle_Activate(DepartmentDescription_t *d)
+{
+    VehicleState_t *v = NULL;
+    BaseType_t parked = pdFALSE;
+
+    taskENTER_CRITICAL();
+    if (d->vehicles < d->maxVehicles) {
+        v = &d->fleet[d->vehicles++];
+        v->retire = pdFALSE; // Still finishing its last job - it simply stays
+        parked = v->parked;
+#if SERVICE_CLOCK
+        v->parked = pdFALSE; // Vehicle records are unparked here - vehicle tasks unpark themselves (VehiclePark)
+#endif
+    }
+    taskEXIT_CRITICAL();
 
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
+    if (v == NULL) return pdFALSE; // At maxVehicles
 
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
+#if SERVICE_CLOCK
+    if (parked) {
+        FleetStats_SetActivity(v, VEHICLE_IDLE);
+        IdlePush(v); // Idle before its token exists - whoever takes the token always finds an idle vehicle
+    }
+#else
+    (void)parked;
+    if (v->task == NULL) { // Spare that never ran
+        char taskName[32];
+        snprintf(taskName, sizeof(taskName), "%s_%u", d->name, (unsigned)(v->index + 1));
+
+        if (xTaskCreate(Task_Vehicle, taskName, configMINIMAL_STACK_SIZE, v, VEHICLE_TASK_PRIORITY, &v->task) != pdPASS) {
+            printf("[Client][%s] ERROR: xTaskCreate(%s) failed - fleet stays at %u\n",
+                   pcTaskGetName(NULL), taskName, (unsigned)(d->vehicles - 1));
+            taskENTER_CRITICAL();
+            v->retire = pdTRUE;
+            d->vehicles--;
+            taskEXIT_CRITICAL();
+            return pdFALSE;
         }
+    }
+    else {
+        (void)xTaskNotifyGive(v->task); // Wakes it if parked (VehiclePark re-checks its flag)
+    }
+#endif
 
+    Dept_FleetGrow(d); // One vehicle token more
+    return pdTRUE;
+}
+
+BaseType_t Vehicle_Retire(DepartmentDescription_t *d)
+{
+    VehicleState_t *v = NULL;
+    BaseType_t parked = pdFALSE;
+
+    taskENTER_CRITICAL();
+    if (d->vehicles > d->minVehicles) {
+        v = &d->fleet[--d->vehicles];
+        v->retire = pdTRUE;
+#if VEHICLE_HANDOFF
+        if (!v->parked && IdleRemove(v)) { // Idle - no mail can reach it any more
+            v->parked = pdTRUE;
+            parked = pdTRUE;
+        }
+#endif
     }
+    taskEXIT_CRITICAL();
 
-    vTaskDelete(NULL); // Should never reach here
+    if (v == NULL) return pdFALSE; // At minVehicles
+
+#if SERVICE_CLOCK
+    if (parked) {
+        char name[32];
+        VehicleName(v, name, sizeof(name));
+        FleetStats_SetActivity(v, VEHICLE_RETIRED);
+        printf("[Client][%s] RETIRED - parked until the fleet grows\n", name);
+    }
+    /* else: busy - ServiceClockComplete() parks it */
+#elif VEHICLE_HANDOFF
+    if (parked) {
+        (void)xTaskNotifyGiveIndexed(v->task, VEHICLE_MAILBOX_INDEX); // Wakes it from its mailbox - to park, not to serve
+    }
+    /* else: busy - it parks before going idle again */
+#else
+    (void)parked; // Pull mode - it parks the next time it looks at the backlog
+#endif
+    return pdTRUE;
 }
 
-void Task_Electricity_X(void *pvParameters)
+void Task_Vehicle(void *pvParameters)
 {
-    (void)pvParameters;
+    VehicleState_t *self = (VehicleState_t *)pvParameters;
+    DepartmentDescription_t *d = (self != NULL) ? self->dept : NULL;
+    if (d == NULL || d->queue == NULL || d->availableSem == NULL) {
+        printf("[Client][VEHICLE] Bad params -> deleting task\n");
+        vTaskDelete(NULL);
+    }
+
+    self->task = xTaskGetCurrentTaskHandle(); // Handoff mailbox owner
+
+    self->position = VehicleStartPosition(d, self->index);
+    self->parked = pdFALSE; // Spare slots start parked (Dept_Register) - running now
+    self->idle = pdTRUE;
+    FleetStats_SetActivity(self, VEHICLE_IDLE);
+
+    /* Vehicles of helper departments wake up periodically while idle to look for mutual aid work */
+    TickType_t idleWait = portMAX_DELAY;
+#if MUTUAL_AID_ENABLE
+    if (MutualAid_IsHelper(d)) idleWait = pdMS_TO_TICKS(MUTUAL_AID_POLL_MS);
+#endif
+
+    /* Claim-with-grace: the head event goes to the nearest idle vehicle, others take it only after a grace period */
+    uint32_t   graceEventID = 0;
+    TickType_t graceStart   = 0;
 
-    printf("[Client][%s] Started\n", pcTaskGetName(NULL));
+    printf("[Client][%s] Started (dept=%s position=Street %u)\n", pcTaskGetName(NULL), d->name, (unsigned)self->position);
 
-    /* Main loop for Electricity Department -> Dispatcher communication */
+#if VEHICLE_HANDOFF && !SERVICE_CLOCK
+    VehicleHandoffLoop(self, idleWait); // Never returns
+#endif
+
+    /* Main loop for Vehicle -> Dispatcher communication */
     for (;;) {
-        EmergencyEvent_t event;
+        DeptJob_t job;
 
-        // 1) Wait for an event to exist (do NOT remove it yet)
-        if (xQueuePeek(handle_deptAmbulanceQ, &event, portMAX_DELAY) != pdPASS) {
-            continue;
-        }
-    
-        // 2) Get the resource semaphore for this department/type
-        SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type);
-        if (countSemaphore == NULL) {
-            // remove the bad event so we don't deadlock on the same head-of-queue forever
-            (void)xQueueReceive(handle_deptAmbulanceQ, &event, 0);
-            printf("[Client][%s] ERROR: Semaphore handle is NULL (type=%d)\n",
-                   pcTaskGetName(NULL), (int)event.type);
+        VehiclePark(self); // Retired by the autoscaler - wait until the fleet grows again
+
+        // 1) Wait for an event to exist in our department queue (do NOT remove it yet) - head is the earliest deadline
+        if (xPQueuePeek(d->queue, &job, NULL, idleWait) != pdPASS) {
+#if MUTUAL_AID_ENABLE
+            VehicleServeMutualAid(self); // Own queue idle - help a saturated department
+#endif
             continue;
         }
-    
-        // 3) Wait until a vehicle/resource is available (manager "break" will block us here)
-        xSemaphoreTake(countSemaphore, portMAX_DELAY);
-
-        /* Receive an emergency event from the Dispatcher queue */
-        if (xQueueReceive(handle_deptElectQ, &event, portMAX_DELAY) == pdPASS) {
-            
-            SemaphoreHandle_t countSemaphore = DeptSemFromType(event.type); // Returns handleSem_deptElect
-            /* Check if the semaphore handle is valid */
-            if (countSemaphore == NULL) {
-                printf("[Client][%s] ERROR: Semaphore handle is NULL\n", pcTaskGetName(NULL));
-                continue;
-            }
-            xSemaphoreTake(countSemaphore, portMAX_DELAY); // blocks if no vehicles available (counting semaphore)
-            
-            printf("[Client][%s] Handling event id=%u type=%d priority=%d\n",
-                   pcTaskGetName(NULL), (unsigned)event.eventID, (int)event.type, (int)event.priority);
-            /* Simulate handling the event - Very long delay */
-            vTaskDelay(pdMS_TO_TICKS(baseEventHandling_Delay_MS * event.delayFactor)); // Simulated handling time
-
-            /* Prepare completion message */
-            CompletionMsg_t Msg;
-            Msg.eventID   = event.eventID;
-            Msg.status    = 0; // Success
-            snprintf(Msg.handledBy, sizeof(Msg.handledBy), "%s", pcTaskGetName(NULL));
-            Msg.timestampEnd = xTaskGetTickCount(); // Current tick count as end timestamp
-
-            /* Send completion message to Client UDP TX queue */
-            BaseType_t queueCheck = xQueueSend(handle_clientUDPTxQ, &Msg, 0);
-            if (queueCheck != pdPASS) {
-                printf("[Client][%s] Drop completion message id=%u (TX queue full)\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
+        if (self->retire) continue; // Retired while waiting - park, the active vehicles take it
+
+        // 2) Leave the event to a nearer idle vehicle - unless it did not claim it within the grace period
+        VehicleState_t *nearest = NearestIdleVehicle(d, Location_Parse(job.event.location));
+        if (nearest != NULL && nearest != self) {
+            const TickType_t now = xTaskGetTickCount();
+            if (graceEventID != job.event.eventID) {
+                graceEventID = job.event.eventID;
+                graceStart   = now;
             }
-            else {
-                printf("[Client][%s] Sent completion message id=%u\n", pcTaskGetName(NULL), (unsigned)Msg.eventID);
+            const TickType_t waited = now - graceStart;
+            if (waited < pdMS_TO_TICKS(VEHICLE_CLAIM_GRACE_MS)) {
+                (void)xTaskNotifyGiveIndexed(nearest->task, VEHICLE_CLAIM_INDEX); // It may be waiting out a grace period of its own
+                (void)ulTaskNotifyTakeIndexed(VEHICLE_CLAIM_INDEX, pdTRUE,        // Until the grace ends, or we become the nearest
+                                              pdMS_TO_TICKS(VEHICLE_CLAIM_GRACE_MS) - waited);
+                continue;
             }
-
-            printf("[Client][%s] Completed event id=%u\n", pcTaskGetName(NULL), (unsigned)event.eventID);
-
-            xSemaphoreGive(countSemaphore); // Release vehicle resource back
         }
-
+        graceEventID = 0;
+    
+        // 3) Wait until the vehicles the event needs are available - all at once (manager "break" will block us here)
+        self->idle = pdFALSE; // Cannot move before the reservation passes - not a candidate for NearestIdleVehicle()
+        FleetStats_SetActivity(self, VEHICLE_WAITING);
+        const UBaseType_t reserved = Dept_EventUnits(d, &job.event);
+        (void)Dept_Reserve(d, reserved, portMAX_DELAY);
+
+        /* Receive an emergency event from the Dispatcher queue - the most urgent one the reservation covers */
+        uint32_t deadline; // Queue key = deadline tick (EDF)
+        self->units = VehicleTakeReserved(d, reserved, &job, &deadline);
+        if (self->units > 0) {
+            FleetStats_SetActivity(self, VEHICLE_BUSY);
+            Dept_OnServiceStart(d, &job, deadline);
+            Dept_SignalManager(d, DEPT_SIG_VEHICLE); // Backlog shrank, token taken - saturation / aid may change
+            VehicleClaimNext(d); // The new head may belong to a vehicle waiting out its grace period
+
+            VehicleHandleEvent(self, d, &job, deadline, 0);
+
+            Dept_Release(d, self->units); // Release vehicle resources back (the whole gang)
+            self->idle = pdTRUE;
+            FleetStats_SetActivity(self, VEHICLE_IDLE);
+            Dept_SignalManager(d, DEPT_SIG_VEHICLE); // Vehicle free again - break policy may use it
+        }
+        else {
+            self->idle = pdTRUE;
+            FleetStats_SetActivity(self, VEHICLE_IDLE); // Taken by another vehicle meanwhile - tokens given back
+        }
     }
 
     vTaskDelete(NULL); // Should never reach here
 }
-
@@ -0,0 +1,303 @@
+/**
+ * @file PriorityQueue.c
+ * @brief Implementation of the priority-ordered queue (twin min/max binary heaps over a slot pool).
+ *
+ * @attention Heap updates and item copies run inside a critical section, blocking is done on the
+ *            'items' / 'spaces' counting semaphores outside of it (same split as QosLanes_Send/Receive).
+ */
+
+#include "PriorityQueue.h"
+
+#include <string.h>
+
+#define PQ_MIN  0 // Index of the min-heap (most urgent on top)
+#define PQ_MAX  1 // Index of the max-heap (least urgent on top)
+
+/* One slot of the pool - the item bytes live at items + slot * itemSize */
+typedef struct {
+    uint32_t    key;
+    uint32_t    seq;        // Insertion order - breaks ties between equal keys
+    UBaseType_t pos[2];     // Position of this slot in the min-heap / max-heap
+} PQueueNode_t;
+
+struct PQueueDefinition {
+    UBaseType_t         length;
+    UBaseType_t         itemSize;
+    UBaseType_t         count;      // Items in the queue (= size of both heaps)
+    uint32_t            nextSeq;
+
+    PQueueNode_t        *nodes;     // Slot pool [length]
+    UBaseType_t         *heap[2];   // Slot indices ordered as min-heap / max-heap [length each]
+    UBaseType_t         *freeSlots; // Stack of unused slots [length]
+    uint8_t             *items;     // Item storage [length * itemSize]
+
+    SemaphoreHandle_t   itemsSem;   // counting sem = items in the queue
+    SemaphoreHandle_t   spacesSem;  // counting sem = free spaces
+};
+
+
+/**
+ * @brief Returns pdTRUE if slot a is more urgent than slot b (smaller key, then older) - both compared wrap-safe.
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t MoreUrgent(const PQueueHandle_t pq, UBaseType_t a, UBaseType_t b)
+{
+    const PQueueNode_t *na = &pq->nodes[a];
+    const PQueueNode_t *nb = &pq->nodes[b];
+    if (na->key != nb->key) return ((int32_t)(na->key - nb->key) < 0) ? pdTRUE : pdFALSE; // Wrap-safe (tick keys)
+    return ((int32_t)(na->seq - nb->seq) < 0) ? pdTRUE : pdFALSE; // Wrap-safe
+}
+
+/**
+ * @brief Returns pdTRUE if slot a belongs above slot b in the given heap.
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t HeapAbove(const PQueueHandle_t pq, int h, UBaseType_t a, UBaseType_t b)
+{
+    return (h == PQ_MIN) ? MoreUrgent(pq, a, b) : MoreUrgent(pq, b, a);
+}
+
+/**
+ * @brief Places a slot at a heap position and records the position in the slot.
+ * @attention This function is static and only used within this file.
+ */
+static void HeapSet(PQueueHandle_t pq, int h, UBaseType_t pos, UBaseType_t slot)
+{
+    pq->heap[h][pos] = slot;
+    pq->nodes[slot].pos[h] = pos;
+}
+
+/**
+ * @brief Moves the slot at pos up until its parent is above it.
+ * @attention This function is static and only used within this file.
+ */
+static void HeapSiftUp(PQueueHandle_t pq, int h, UBaseType_t pos)
+{
+    UBaseType_t slot = pq->heap[h][pos];
+    while (pos > 0) {
+        UBaseType_t parent = (pos - 1) / 2;
+        if (!HeapAbove(pq, h, slot, pq->heap[h][parent])) break;
+        HeapSet(pq, h, pos, pq->heap[h][parent]);
+        pos = parent;
+    }
+    HeapSet(pq, h, pos, slot);
+}
+
+/**
+ * @brief Moves the slot at pos down until both children are below it.
+ * @param n - Heap size
+ * @attention This function is static and only used within this file.
+ */
+static void HeapSiftDown(PQueueHandle_t pq, int h, UBaseType_t pos, UBaseType_t n)
+{
+    UBaseType_t slot = pq->heap[h][pos];
+    for (;;) {
+        UBaseType_t child = 2 * pos + 1;
+        if (child >= n) break;
+        if (child + 1 < n && HeapAbove(pq, h, pq->heap[h][child + 1], pq->heap[h][child])) child++;
+        if (!HeapAbove(pq, h, pq->heap[h][child], slot)) break;
+        HeapSet(pq, h, pos, pq->heap[h][child]);
+        pos = child;
+    }
+    HeapSet(pq, h, pos, slot);
+}
+
+/**
+ * @brief Removes the slot at pos from a heap whose new size is n.
+ * @attention This function is static and only used within this file.
+ */
+static void HeapRemoveAt(PQueueHandle_t pq, int h, UBaseType_t pos, UBaseType_t n)
+{
+    if (pos == n) return; // Removed the last element - nothing to fill
+
+    UBaseType_t last = pq->heap[h][n];
+    HeapSet(pq, h, pos, last); // Fill the hole with the last element and restore order (moves either down or up)
+    HeapSiftDown(pq, h, pos, n);
+    HeapSiftUp(pq, h, pq->nodes[last].pos[h]);
+}
+
+/**
+ * @brief Removes a slot from both heaps and copies its item out.
+ * @attention Called inside the critical section with count > 0.
+ * @attention This function is static and only used within this file.
+ */
+static void PQueueRemoveSlot(PQueueHandle_t pq, UBaseType_t slot, void *pvItem, uint32_t *pulKey)
+{
+    PQueueNode_t *node = &pq->nodes[slot];
+
+    memcpy(pvItem, pq->items + (size_t)slot * pq->itemSize, pq->itemSize);
+    if (pulKey) *pulKey = node->key;
+
+    UBaseType_t n = --pq->count;
+    HeapRemoveAt(pq, PQ_MIN, node->pos[PQ_MIN], n);
+    HeapRemoveAt(pq, PQ_MAX, node->pos[PQ_MAX], n);
+
+    pq->freeSlots[pq->length - 1 - n] = slot; // Free stack grows as the heaps shrink
+}
+
+
+PQueueHandle_t xPQueueCreate(UBaseType_t uxLength, UBaseType_t uxItemSize)
+{
+    if (uxLength == 0 || uxItemSize == 0) return NULL;
+
+    PQueueHandle_t pq = pvPortMalloc(sizeof(*pq));
+    if (pq == NULL) return NULL;
+    memset(pq, 0, sizeof(*pq));
+
+    pq->length    = uxLength;
+    pq->itemSize  = uxItemSize;
+    pq->nodes     = pvPortMalloc(uxLength * sizeof(PQueueNode_t));
+    pq->heap[0]   = pvPortMalloc(uxLength * sizeof(UBaseType_t));
+    pq->heap[1]   = pvPortMalloc(uxLength * sizeof(UBaseType_t));
+    pq->freeSlots = pvPortMalloc(uxLength * sizeof(UBaseType_t));
+    pq->items     = pvPortMalloc((size_t)uxLength * uxItemSize);
+    pq->itemsSem  = xSemaphoreCreateCounting(uxLength, 0);
+    pq->spacesSem = xSemaphoreCreateCounting(uxLength, uxLength);
+
+    if (!pq->nodes || !pq->heap[0] || !pq->heap[1] || !pq->freeSlots || !pq->items ||
+        !pq->itemsSem || !pq->spacesSem) {
+        vPQueueDelete(pq);
+        return NULL;
+    }
+
+    for (UBaseType_t i = 0; i < uxLength; i++) {
+        pq->freeSlots[i] = uxLength - 1 - i; // Pop order 0, 1, 2 ... (top of stack is at index length-1-count)
+    }
+
+    return pq;
+}
+
+void vPQueueDelete(PQueueHandle_t xPQueue)
+{
+    if (xPQueue == NULL) return;
+
+    if (xPQueue->itemsSem)  vSemaphoreDelete(xPQueue->itemsSem);
+    if (xPQueue->spacesSem) vSemaphoreDelete(xPQueue->spacesSem);
+    vPortFree(xPQueue->items);
+    vPortFree(xPQueue->freeSlots);
+    vPortFree(xPQueue->heap[1]);
+    vPortFree(xPQueue->heap[0]);
+    vPortFree(xPQueue->nodes);
+    vPortFree(xPQueue);
+}
+
+BaseType_t xPQueueSend(PQueueHandle_t xPQueue, const void *pvItem, uint32_t ulKey, TickType_t xTicksToWait)
+{
+    if (xSemaphoreTake(xPQueue->spacesSem, xTicksToWait) != pdPASS) {
+        return errQUEUE_FULL;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        UBaseType_t n = xPQueue->count++;
+        UBaseType_t slot = xPQueue->freeSlots[xPQueue->length - 1 - n];
+
+        xPQueue->nodes[slot].key = ulKey;
+        xPQueue->nodes[slot].seq = xPQueue->nextSeq++;
+        memcpy(xPQueue->items + (size_t)slot * xPQueue->itemSize, pvItem, xPQueue->itemSize);
+
+        HeapSet(xPQueue, PQ_MIN, n, slot);
+        HeapSiftUp(xPQueue, PQ_MIN, n);
+        HeapSet(xPQueue, PQ_MAX, n, slot);
+        HeapSiftUp(xPQueue, PQ_MAX, n);
+    }
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(xPQueue->itemsSem); // Item is already in the heaps - a receiver will always find it
+    return pdPASS;
+}
+
+BaseType_t xPQueueReceive(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait)
+{
+    if (xSemaphoreTake(xPQueue->itemsSem, xTicksToWait) != pdPASS) {
+        return pdFAIL;
+    }
+
+    taskENTER_CRITICAL();
+    PQueueRemoveSlot(xPQueue, xPQueue->heap[PQ_MIN][0], pvItem, pulKey);
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(xPQueue->spacesSem);
+    return pdPASS;
+}
+
+BaseType_t xPQueuePeek(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey, TickType_t xTicksToWait)
+{
+    TimeOut_t timeOut;
+    vTaskSetTimeOutState(&timeOut);
+
+    for (;;) {
+        BaseType_t found = pdFALSE;
+
+        /* Read the root without touching the item count - concurrent zero-wait receivers never see it taken */
+        taskENTER_CRITICAL();
+        if (xPQueue->count > 0) {
+            UBaseType_t slot = xPQueue->heap[PQ_MIN][0];
+            memcpy(pvItem, xPQueue->items + (size_t)slot * xPQueue->itemSize, xPQueue->itemSize);
+            if (pulKey) *pulKey = xPQueue->nodes[slot].key;
+            found = pdTRUE;
+        }
+        taskEXIT_CRITICAL();
+
+        if (found) return pdPASS;
+
+        /* Empty - wait on the item count, give it straight back and read the root again */
+        if (xTaskCheckForTimeOut(&timeOut, &xTicksToWait) == pdTRUE) return pdFAIL;
+        if (xSemaphoreTake(xPQueue->itemsSem, xTicksToWait) != pdPASS) return pdFAIL;
+        xSemaphoreGive(xPQueue->itemsSem); // Only waited - the item stays in the queue
+    }
+}
+
+BaseType_t xPQueueRemoveLowest(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey)
+{
+    if (xSemaphoreTake(xPQueue->itemsSem, 0) != pdPASS) {
+        return pdFAIL;
+    }
+
+    taskENTER_CRITICAL();
+    PQueueRemoveSlot(xPQueue, xPQueue->heap[PQ_MAX][0], pvItem, pulKey);
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(xPQueue->spacesSem);
+    return pdPASS;
+}
+
+BaseType_t xPQueueReceiveIf(PQueueHandle_t xPQueue, void *pvItem, uint32_t *pulKey,
+                            PQueuePredicate_t xPredicate, void *pvContext)
+{
+    if (xSemaphoreTake(xPQueue->itemsSem, 0) != pdPASS) {
+        return pdFAIL;
+    }
+
+    BaseType_t found = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        UBaseType_t best = 0;
+        for (UBaseType_t i = 0; i < xPQueue->count; i++) {
+            UBaseType_t slot = xPQueue->heap[PQ_MIN][i];
+            if ((found && !MoreUrgent(xPQueue, slot, best)) ||
+                !xPredicate(xPQueue->items + (size_t)slot * xPQueue->itemSize, pvContext)) {
+                continue;
+            }
+            best = slot;
+            found = pdTRUE;
+        }
+
+        if (found) PQueueRemoveSlot(xPQueue, best, pvItem, pulKey);
+    }
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(found ? xPQueue->spacesSem : xPQueue->itemsSem); // Nothing taken - item count stays
+    return found ? pdPASS : pdFAIL;
+}
+
+UBaseType_t uxPQueueMessagesWaiting(PQueueHandle_t xPQueue)
+{
+    return uxSemaphoreGetCount(xPQueue->itemsSem);
+}
+
+UBaseType_t uxPQueueSpacesAvailable(PQueueHandle_t xPQueue)
+{
+    return uxSemaphoreGetCount(xPQueue->spacesSem);
+}
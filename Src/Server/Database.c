@@ -14,11 +14,6 @@
 #define SQLITE_DB_PATH "EventLog.db"
 #endif // SQLITE_DB_PATH
 
-/* Status code for pending events */
-#ifndef STATUS_PENDING 
-#define STATUS_PENDING 1
-#endif
-
 static sqlite3 *handle_db = NULL; // Global DB handle initialized to NULL
 static SemaphoreHandle_t handle_dbMutex = NULL; // Mutex for thread-safe DB access
 
@@ -53,7 +48,7 @@ void Db_Init(void)
         " ts_start      INTEGER NOT NULL,"
         " ts_end        INTEGER,"
         " handled_by    TEXT,"
-        " status        INTEGER NOT NULL"
+        " status        INTEGER NOT NULL" // STATUS_xxx (Shared_Configuration.h), STATUS_PENDING until the completion arrives
         ");";
 
     /* Execute the schema creation SQL */
@@ -0,0 +1,248 @@
+/**
+ * @file Server_Bench.c
+ * @brief Implementation of the transport-only benchmark (generator, latency histogram and report).
+ * @attention Only compiled in when TRANSPORT_BENCH=1.
+ * @attention This file is part of the Server module.
+ */
+
+#include "Server/Server_Bench.h"
+
+#if TRANSPORT_BENCH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "Server/Server_Task.h" // eventCatalog - realistic priority / type mix
+#include "Server/Server_UDP.h" // Fast path send
+
+/* Log-linear latency histogram: values < 2^HIST_SUB_BITS us get their own bucket,
+   above that every power of two is split into 2^HIST_SUB_BITS buckets (~3% resolution) */
+#define HIST_SUB_BITS   5
+#define HIST_SUB        (1u << HIST_SUB_BITS)
+#define HIST_BUCKETS    ((32 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+/* Send time of an in-flight event */
+typedef struct {
+    uint32_t eventID;
+    uint64_t sentUs; // 0 = free / already completed
+} BenchSlot_t;
+
+/* Counters of one report window */
+typedef struct {
+    uint32_t hist[HIST_BUCKETS];
+    uint32_t sent;      // Events handed to the TX lanes
+    uint32_t drops;     // Events the TX lanes did not accept in time
+    uint32_t received;  // Completions matched to a sent event
+    uint64_t maxUs;     // Max round trip in the window
+} BenchWindow_t;
+
+static BenchSlot_t   slots[BENCH_INFLIGHT_MAX];
+static BenchWindow_t window; // Shared by generator and UDP-RX task - accessed under critical section
+
+
+/**
+ * @brief Monotonic clock in microseconds (independent of the FreeRTOS 1 ms tick).
+ * @attention This function is static and only used within this file.
+ */
+static uint64_t BenchNowUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * @brief Context switches of the whole process so far (voluntary + involuntary, all threads).
+ *        The POSIX port runs every FreeRTOS task on its own thread, so each task switch shows up here.
+ * @attention This function is static and only used within this file.
+ */
+static uint64_t BenchContextSwitches(void)
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (uint64_t)ru.ru_nvcsw + (uint64_t)ru.ru_nivcsw;
+}
+
+/**
+ * @brief Maps a latency to its histogram bucket.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t HistBucket(uint32_t us)
+{
+    if (us < HIST_SUB) return us;
+
+    uint32_t e = 31u - (uint32_t)__builtin_clz(us); // floor(log2(us)) >= HIST_SUB_BITS
+    return (e - HIST_SUB_BITS + 1) * HIST_SUB + ((us >> (e - HIST_SUB_BITS)) - HIST_SUB);
+}
+
+/**
+ * @brief Lower bound (us) of a histogram bucket.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t HistValue(uint32_t bucket)
+{
+    if (bucket < HIST_SUB) return bucket;
+
+    uint32_t e = bucket / HIST_SUB - 1 + HIST_SUB_BITS;
+    return (HIST_SUB + bucket % HIST_SUB) << (e - HIST_SUB_BITS);
+}
+
+/**
+ * @brief Returns the latency (us) below which 'permille' of the samples fall.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t HistPercentile(const BenchWindow_t *w, uint32_t permille)
+{
+    if (w->received == 0) return 0;
+
+    uint64_t target = ((uint64_t)w->received * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < HIST_BUCKETS; b++) {
+        seen += w->hist[b];
+        if (seen >= target) return HistValue(b);
+    }
+    return (uint32_t)w->maxUs;
+}
+
+
+void ServerBench_OnCompletion(const CompletionMsg_t *msg)
+{
+    uint64_t now = BenchNowUs();
+    BenchSlot_t *slot = &slots[msg->eventID & (BENCH_INFLIGHT_MAX - 1)];
+
+    taskENTER_CRITICAL();
+    if (slot->eventID == msg->eventID && slot->sentUs != 0) {
+        uint64_t rtt = now - slot->sentUs;
+        slot->sentUs = 0; // Count every event once
+
+        window.hist[HistBucket(rtt > UINT32_MAX ? UINT32_MAX : (uint32_t)rtt)]++;
+        window.received++;
+        if (rtt > window.maxUs) window.maxUs = rtt;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void Task_BenchGenerator(void *pvParameters)
+{
+    (void)pvParameters;
+
+    uint32_t rate = BENCH_RATE_HZ; // Current target rate (events/sec)
+    uint32_t bestRate = 0; // Highest rate that was sustained
+    BaseType_t ramping = BENCH_RAMP;
+    uint32_t eventID = 1;
+    uint32_t credit = 0; // Events owed, in 1/1000 events (rate is added every 1 ms)
+    uint32_t reports = 0; // Report windows so far
+
+    srand((unsigned)time(NULL));
+
+    printf("[BENCH] Transport benchmark started (rate=%u/s ramp=%d report=%ums path=%s)\n",
+           (unsigned)rate, (int)ramping, (unsigned)BENCH_REPORT_MS, FAST_PATH ? "fast" : "pipeline");
+    vTaskDelay(pdMS_TO_TICKS(Long_Delay_MS)); // Let the client bind its socket
+
+    TickType_t lastWake = xTaskGetTickCount();
+    TickType_t windowStart = lastWake;
+    uint64_t windowCsw = BenchContextSwitches();
+    memset(&window, 0, sizeof(window));
+
+    /* Main loop - one iteration per tick */
+    for (;;) {
+        vTaskDelayUntil(&lastWake, 1);
+
+        credit += (uint32_t)((uint64_t)rate * portTICK_PERIOD_MS);
+        while (credit >= 1000u) {
+            credit -= 1000u;
+
+            const EventCatalogItem_t *item = &eventCatalog[rand() % eventCatalogCount];
+            EmergencyEvent_t event;
+            memset(&event, 0, sizeof(event));
+            event.eventID     = eventID++;
+            event.type        = item->type;
+            event.priority    = item->priority;
+            event.delayFactor = item->delayFactor;
+            event.units       = item->units;
+            snprintf(event.event_detail, sizeof(event.event_detail), "%s", item->detail);
+            snprintf(event.location, sizeof(event.location), "Street %u", (unsigned)(rand() % 100U));
+            event.timestampStart = (uint32_t)xTaskGetTickCount();
+
+            BenchSlot_t *slot = &slots[event.eventID & (BENCH_INFLIGHT_MAX - 1)];
+            taskENTER_CRITICAL();
+            slot->eventID = event.eventID;
+            slot->sentUs  = BenchNowUs();
+            taskEXIT_CRITICAL();
+
+#if FAST_PATH
+            BaseType_t ok = ServerUDP_SendEvent(&event); // Straight to the socket
+#else
+            BaseType_t ok = QosLanes_Send(&lanes_serverUDPTx, &event, pdMS_TO_TICKS(Short_Delay_MS));
+#endif
+
+            taskENTER_CRITICAL();
+            if (ok == pdPASS) {
+                window.sent++;
+            } else {
+                window.drops++;
+                slot->sentUs = 0;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /* ---------------- Periodic report ---------------- */
+        TickType_t now = xTaskGetTickCount();
+        if ((now - windowStart) < pdMS_TO_TICKS(BENCH_REPORT_MS)) continue;
+
+        static BenchWindow_t w; // Static - too large for the task stack
+        taskENTER_CRITICAL();
+        w = window;
+        memset(&window, 0, sizeof(window));
+        taskEXIT_CRITICAL();
+
+        const uint32_t ms = (uint32_t)((now - windowStart) * portTICK_PERIOD_MS);
+        windowStart = now;
+
+        const uint64_t csw = BenchContextSwitches();
+        const uint64_t cswWindow = csw - windowCsw;
+        windowCsw = csw;
+
+        const uint32_t target  = (uint32_t)((uint64_t)rate * ms / 1000u);
+        const uint32_t lost    = (w.sent + w.drops > w.received) ? (w.sent + w.drops - w.received) : 0;
+        const uint32_t thr     = (uint32_t)((uint64_t)w.received * 1000u / (ms ? ms : 1));
+        const uint32_t p99     = HistPercentile(&w, 990);
+        const uint32_t lossPm  = target ? (uint32_t)((uint64_t)lost * 1000u / target) : 0;
+
+        printf("[BENCH] rate=%u/s sent=%u drops=%u recv=%u lost=%u thr=%u/s "
+               "p50=%uus p90=%uus p99=%uus p99.9=%uus max=%uus csw/event=%u.%02u\n",
+               (unsigned)rate, (unsigned)w.sent, (unsigned)w.drops, (unsigned)w.received, (unsigned)lost,
+               (unsigned)thr, (unsigned)HistPercentile(&w, 500), (unsigned)HistPercentile(&w, 900),
+               (unsigned)p99, (unsigned)HistPercentile(&w, 999), (unsigned)w.maxUs,
+               (unsigned)(w.received ? cswWindow / w.received : 0),
+               (unsigned)(w.received ? cswWindow * 100u / w.received % 100u : 0));
+
+        /* ---------------- Ramp: double while sustained ---------------- */
+        if (!ramping || ++reports == 1) continue; // First window is warm-up (sockets, caches, heartbeat)
+
+        const BaseType_t sustained = (w.sent >= target - target / 100u) &&
+                                     (lossPm <= BENCH_LOSS_LIMIT_PERMILLE) &&
+                                     (p99 <= BENCH_P99_LIMIT_US);
+        if (sustained && rate < BENCH_MAX_RATE_HZ) {
+            bestRate = rate;
+            rate = (rate * 2u > BENCH_MAX_RATE_HZ) ? BENCH_MAX_RATE_HZ : rate * 2u;
+            continue;
+        }
+
+        if (sustained) bestRate = rate;
+        ramping = pdFALSE;
+        rate = bestRate ? bestRate : rate;
+        printf("[BENCH] Max sustainable rate=%u/s (p99 limit %uus, loss limit %u/1000) - holding this rate\n",
+               (unsigned)bestRate, (unsigned)BENCH_P99_LIMIT_US, (unsigned)BENCH_LOSS_LIMIT_PERMILLE);
+    }
+
+    vTaskDelete(NULL); // Delete and free resources - Should never reach here
+}
+
+#endif // TRANSPORT_BENCH
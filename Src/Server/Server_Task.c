@@ -17,6 +17,7 @@
 #include "task.h"
 
 #include "Server/DataBase.h" // Database functions
+#include "Server/Server_UDP.h" // Fast path send
 
 #include "Server/Server_Task.h"
 
@@ -25,43 +26,43 @@
 const EventCatalogItem_t eventCatalog[] = {
 
     /* Ambulance */
-    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Severe traffic accident", 60},
-    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Heart attack patient", 40},
-    { EVENT_AMBULANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Minor accident", 10},
-    { EVENT_AMBULANCE, LOW_EVENT_PRIORITY_LEVEL, "Minor injury", 5},
-    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Emergency in public building", 25},
+    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Severe traffic accident", 60, 2},
+    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Heart attack patient", 40, 1},
+    { EVENT_AMBULANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Minor accident", 10, 1},
+    { EVENT_AMBULANCE, LOW_EVENT_PRIORITY_LEVEL, "Minor injury", 5, 1},
+    { EVENT_AMBULANCE, HIGH_EVENT_PRIORITY_LEVEL, "Emergency in public building", 25, 1},
     /* Police */
-    { EVENT_POLICE, MEDIUM_EVENT_PRIORITY_LEVEL, "Illegal gathering", 15},
-    { EVENT_POLICE, HIGH_EVENT_PRIORITY_LEVEL, "Home burglary", 20},
-    { EVENT_POLICE, LOW_EVENT_PRIORITY_LEVEL, "Traffic violation", 5},
-    { EVENT_POLICE, HIGH_EVENT_PRIORITY_LEVEL, "Violence incident", 25},
-    { EVENT_POLICE, MEDIUM_EVENT_PRIORITY_LEVEL, "City emergency assistance", 20},
+    { EVENT_POLICE, MEDIUM_EVENT_PRIORITY_LEVEL, "Illegal gathering", 15, 1},
+    { EVENT_POLICE, HIGH_EVENT_PRIORITY_LEVEL, "Home burglary", 20, 1},
+    { EVENT_POLICE, LOW_EVENT_PRIORITY_LEVEL, "Traffic violation", 5, 1},
+    { EVENT_POLICE, HIGH_EVENT_PRIORITY_LEVEL, "Violence incident", 25, 2},
+    { EVENT_POLICE, MEDIUM_EVENT_PRIORITY_LEVEL, "City emergency assistance", 20, 1},
     /* Fire */
-    { EVENT_FIRE_DEPARTMENT, HIGH_EVENT_PRIORITY_LEVEL, "Restaurant fire", 50},
-    { EVENT_FIRE_DEPARTMENT, HIGH_EVENT_PRIORITY_LEVEL, "Residential house fire", 70},
-    { EVENT_FIRE_DEPARTMENT, MEDIUM_EVENT_PRIORITY_LEVEL, "Vehicle fire", 15},
-    { EVENT_FIRE_DEPARTMENT, MEDIUM_EVENT_PRIORITY_LEVEL, "Suspicious smoke", 10},
-    { EVENT_FIRE_DEPARTMENT, LOW_EVENT_PRIORITY_LEVEL, "Open field fire", 5},
+    { EVENT_FIRE_DEPARTMENT, HIGH_EVENT_PRIORITY_LEVEL, "Restaurant fire", 50, 2},
+    { EVENT_FIRE_DEPARTMENT, HIGH_EVENT_PRIORITY_LEVEL, "Residential house fire", 70, 2},
+    { EVENT_FIRE_DEPARTMENT, MEDIUM_EVENT_PRIORITY_LEVEL, "Vehicle fire", 15, 1},
+    { EVENT_FIRE_DEPARTMENT, MEDIUM_EVENT_PRIORITY_LEVEL, "Suspicious smoke", 10, 1},
+    { EVENT_FIRE_DEPARTMENT, LOW_EVENT_PRIORITY_LEVEL, "Open field fire", 5, 1},
 
     /* Maintenance */
-    { EVENT_MAINTENANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Sidewalk repair", 60},
-    { EVENT_MAINTENANCE, HIGH_EVENT_PRIORITY_LEVEL, "Water pipe leak", 50},
-    { EVENT_MAINTENANCE, LOW_EVENT_PRIORITY_LEVEL, "Routine public building maintenance", 10},
-    { EVENT_MAINTENANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Dangerous sewer openings", 15},
-    { EVENT_MAINTENANCE, HIGH_EVENT_PRIORITY_LEVEL, "Roof leak issue", 25},
+    { EVENT_MAINTENANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Sidewalk repair", 60, 1},
+    { EVENT_MAINTENANCE, HIGH_EVENT_PRIORITY_LEVEL, "Water pipe leak", 50, 1},
+    { EVENT_MAINTENANCE, LOW_EVENT_PRIORITY_LEVEL, "Routine public building maintenance", 10, 1},
+    { EVENT_MAINTENANCE, MEDIUM_EVENT_PRIORITY_LEVEL, "Dangerous sewer openings", 15, 1},
+    { EVENT_MAINTENANCE, HIGH_EVENT_PRIORITY_LEVEL, "Roof leak issue", 25, 1},
     /* Waste */
-    { EVENT_WASTE_COLLECTION, MEDIUM_EVENT_PRIORITY_LEVEL, "Full neighborhood bins", 60},
-    { EVENT_WASTE_COLLECTION, HIGH_EVENT_PRIORITY_LEVEL, "Hazardous waste collection", 90},
-    { EVENT_WASTE_COLLECTION, LOW_EVENT_PRIORITY_LEVEL, "Regular bin collection", 15},
-    { EVENT_WASTE_COLLECTION, HIGH_EVENT_PRIORITY_LEVEL, "Large public waste removal", 25},
-    { EVENT_WASTE_COLLECTION, MEDIUM_EVENT_PRIORITY_LEVEL, "Uncollected paper bins from commerce", 15},
+    { EVENT_WASTE_COLLECTION, MEDIUM_EVENT_PRIORITY_LEVEL, "Full neighborhood bins", 60, 1},
+    { EVENT_WASTE_COLLECTION, HIGH_EVENT_PRIORITY_LEVEL, "Hazardous waste collection", 90, 2},
+    { EVENT_WASTE_COLLECTION, LOW_EVENT_PRIORITY_LEVEL, "Regular bin collection", 15, 1},
+    { EVENT_WASTE_COLLECTION, HIGH_EVENT_PRIORITY_LEVEL, "Large public waste removal", 25, 1},
+    { EVENT_WASTE_COLLECTION, MEDIUM_EVENT_PRIORITY_LEVEL, "Uncollected paper bins from commerce", 15, 1},
 
     /* Electricity */
-    { EVENT_ELECTRICITY, LOW_EVENT_PRIORITY_LEVEL, "Streetlight failure", 15},
-    { EVENT_ELECTRICITY, HIGH_EVENT_PRIORITY_LEVEL, "Neighborhood power outage", 30},
-    { EVENT_ELECTRICITY, MEDIUM_EVENT_PRIORITY_LEVEL, "Power off in public building", 15},
-    { EVENT_ELECTRICITY, HIGH_EVENT_PRIORITY_LEVEL, "Overload in power network", 60},
-    { EVENT_ELECTRICITY, MEDIUM_EVENT_PRIORITY_LEVEL, "Traffic light signaling failure", 20},
+    { EVENT_ELECTRICITY, LOW_EVENT_PRIORITY_LEVEL, "Streetlight failure", 15, 1},
+    { EVENT_ELECTRICITY, HIGH_EVENT_PRIORITY_LEVEL, "Neighborhood power outage", 30, 1},
+    { EVENT_ELECTRICITY, MEDIUM_EVENT_PRIORITY_LEVEL, "Power off in public building", 15, 1},
+    { EVENT_ELECTRICITY, HIGH_EVENT_PRIORITY_LEVEL, "Overload in power network", 60, 1},
+    { EVENT_ELECTRICITY, MEDIUM_EVENT_PRIORITY_LEVEL, "Traffic light signaling failure", 20, 1},
 };
 
 const uint32_t eventCatalogCount = (uint32_t)(sizeof(eventCatalog)/sizeof(eventCatalog[0])); // Number of items in the event catalog
@@ -100,6 +101,7 @@ void Task_EventGenerator(void *pvParameters)
         xNewEvent.priority = randCatalogItem->priority; // Set priority from catalog
         snprintf(xNewEvent.event_detail, sizeof(xNewEvent.event_detail), "%s", randCatalogItem->detail); // Set event detail from catalog
         xNewEvent.delayFactor = randCatalogItem->delayFactor; // Set delay factor from catalog
+        xNewEvent.units = randCatalogItem->units; // Set required vehicles from catalog
 
         /* Generate a random location using snprintf */
         snprintf(xNewEvent.location, sizeof(xNewEvent.location),
@@ -111,20 +113,28 @@ void Task_EventGenerator(void *pvParameters)
         Db_InsertEventPending(&xNewEvent); // Insert the new event into the database
         
         /* Print the generated event details */
-        printf("[Server] Generated: ID=%u Type=%d EventDetail='%s' handleTime=%lusec Location='%s' Time=%lusec\n",
+        printf("[Server] Generated: ID=%u Type=%d EventDetail='%s' handleTime=%lusec units=%u Location='%s' Time=%lusec\n",
                (unsigned)xNewEvent.eventID,
                (int)xNewEvent.type,
                xNewEvent.event_detail,
                (unsigned long)(xNewEvent.delayFactor * baseEventHandling_Delay_MS / 1000U), // Handling time in seconds
+               (unsigned)xNewEvent.units, // Vehicles the incident needs
                xNewEvent.location,
                (unsigned long)(now / 1000U));
         
 
-        /* Send the event to the UDP TX queue */
-        if (xQueueSend(handle_serverUDPTxQ, &xNewEvent, pdMS_TO_TICKS(Medium_Delay_MS)) != pdPASS) {
+#if FAST_PATH
+        /* Fast path - write the event straight to the socket */
+        if (ServerUDP_SendEvent(&xNewEvent) != pdPASS) {
+            printf("[Server] WARN: send failed, drop event id=%u\n", (unsigned)xNewEvent.eventID);
+        }
+#else
+        /* Send the event to the UDP TX lane matching its priority */
+        if (QosLanes_Send(&lanes_serverUDPTx, &xNewEvent, pdMS_TO_TICKS(Medium_Delay_MS)) != pdPASS) {
             printf("[Server] WARN: UDP-TX queue full, drop event id=%u\n", (unsigned)xNewEvent.eventID);
         }
         printf("[Server] Sent to queue event id=%u to UDP-TX\n", (unsigned)xNewEvent.eventID);
+#endif
 
 
         vTaskDelay(pdMS_TO_TICKS(EVENT_GENERATION_INTERVAL_MS)); // Delay before generating the next event
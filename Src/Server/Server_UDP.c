@@ -8,15 +8,212 @@
 #include "Server/Server_UDP.h"
 
 #include <errno.h>
+#include <stddef.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 
 #include "Server/DataBase.h" // Database functions
+#include "Server/Server_Bench.h" // Transport benchmark hooks
 
 static int serverSock = -1; // Defining Server UDP socket variable
 
+/* Client (regional dispatch center) membership entry */
+typedef struct {
+    BaseType_t          active;     // Slot is a current member
+    struct sockaddr_in  addr;       // Client address events are sent to
+    uint32_t            eventsSent; // Events routed to this client
+
+    /* Heartbeat clock filter - written by UDP-RX task only, published values read under critical section */
+    uint32_t hbRtt[HEARTBEAT_FILTER_LEN]; // RTT of each kept sample
+    int32_t  hbOffset[HEARTBEAT_FILTER_LEN]; // Offset of each kept sample
+    uint32_t hbCount; // Number of replies received so far
+    int32_t  clockOffset; // Published offset (client - server) in ticks
+    uint32_t clockRtt; // RTT of the published sample in ticks
+} ServerClient_t;
+
+/* Point on the consistent hash ring */
+typedef struct {
+    uint32_t hash;
+    uint32_t client; // Index in clients[]
+} RingPoint_t;
+
+static ServerClient_t clients[UDP_MAX_CLIENTS]; // Membership table
+static RingPoint_t ring[UDP_MAX_CLIENTS * SHARD_VNODES]; // Sorted by hash
+static uint32_t ringCount = 0; // Points currently on the ring
+
+
+/**
+ * @brief 32-bit FNV-1a hash with a final avalanche step so nearby keys spread over the ring.
+ * @param data - Bytes to hash
+ * @param len - Number of bytes
+ * 
+ * @attention This function is static and only used within this file.
+ * @return uint32_t Hash value.
+ */
+static uint32_t ShardHash(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+
+    /* murmur3 fmix32 */
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Rebuilds the consistent hash ring from the active members (SHARD_VNODES points per client).
+ * 
+ * @attention This function is static and must be called with the scheduler suspended.
+ */
+static void ShardRingRebuild(void)
+{
+    ringCount = 0;
+
+    for (uint32_t c = 0; c < UDP_MAX_CLIENTS; c++) {
+        if (!clients[c].active) continue;
+
+        for (uint32_t v = 0; v < SHARD_VNODES; v++) {
+            struct { uint32_t ip; uint16_t port; uint16_t vnode; } key = {
+                clients[c].addr.sin_addr.s_addr, clients[c].addr.sin_port, (uint16_t)v
+            };
+
+            /* Insertion keeps the ring sorted - the ring is small and rarely rebuilt */
+            RingPoint_t point = { ShardHash(&key, sizeof(key)), c };
+            uint32_t j = ringCount++;
+            while (j > 0 && ring[j - 1].hash > point.hash) {
+                ring[j] = ring[j - 1];
+                j--;
+            }
+            ring[j] = point;
+        }
+    }
+}
+
+/**
+ * @brief Finds the member that sent a datagram.
+ * @param sender - Datagram source address
+ * 
+ * @attention This function is static and only used within this file.
+ * @return int Client index, or -1 if the sender is not a member.
+ */
+static int ClientFromAddr(const struct sockaddr_in *sender)
+{
+    for (int c = 0; c < UDP_MAX_CLIENTS; c++) {
+        if (clients[c].active &&
+            clients[c].addr.sin_addr.s_addr == sender->sin_addr.s_addr &&
+            clients[c].addr.sin_port == sender->sin_port) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Handles a heartbeat reply: computes RTT/offset (NTP-style) and publishes the min-RTT offset.
+ * @param c - Client that replied
+ * @param hb - Heartbeat reply from client
+ * @param t4 - Server tick count when the reply was received
+ * 
+ * @attention This function is static and only used by vServerUDPRxTask.
+ */
+static void HeartbeatOnReply(ServerClient_t *c, const HeartbeatMsg_t *hb, uint32_t t4)
+{
+    /* Signed differences keep the math valid over tick counter wrap */
+    uint32_t rtt    = (t4 - hb->t1) - (hb->t3 - hb->t2);
+    int32_t  offset = ((int32_t)(hb->t2 - hb->t1) + (int32_t)(hb->t3 - t4)) / 2;
+
+    uint32_t slot = c->hbCount % HEARTBEAT_FILTER_LEN;
+    c->hbRtt[slot]     = rtt;
+    c->hbOffset[slot]  = offset;
+    c->hbCount++;
+
+    /* Clock filter - the sample with the lowest RTT has the least queuing noise */
+    uint32_t kept = (c->hbCount < HEARTBEAT_FILTER_LEN) ? c->hbCount : HEARTBEAT_FILTER_LEN;
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < kept; i++) {
+        if (c->hbRtt[i] < c->hbRtt[best]) best = i;
+    }
+
+    taskENTER_CRITICAL();
+    c->clockOffset = c->hbOffset[best];
+    c->clockRtt    = c->hbRtt[best];
+    taskEXIT_CRITICAL();
+
+    printf("[Server][HB] client=%u seq=%u rtt=%u offset=%d (published rtt=%u offset=%d)\n",
+           (unsigned)ntohs(c->addr.sin_port), (unsigned)hb->seq, (unsigned)rtt, (int)offset,
+           (unsigned)c->hbRtt[best], (int)c->hbOffset[best]);
+}
+
+
+/**
+ * @brief Handles one completion message: maps its end tick onto the server timeline and updates the DataBase.
+ * @param client - Client index of the sender (-1 if unknown)
+ * @param in - Completion message as received
+ * @param sender - Datagram source address (for logging)
+ * 
+ * @attention This function is static and only used by vServerUDPRxTask.
+ */
+static void ServerOnCompletion(int client, const CompletionMsg_t *in, const struct sockaddr_in *sender)
+{
+    CompletionMsg_t msg = *in;
+    uint32_t clientEnd = msg.timestampEnd;
+    msg.timestampEnd = ServerUDP_ClientToServerTicks(client, clientEnd); // Map onto server timeline
+
+#if TRANSPORT_BENCH
+    ServerBench_OnCompletion(&msg); // Transport benchmark - no DataBase on this path
+    return;
+#endif
+
+    (void)xQueueSend(handle_serverUDPRxQ, &msg, 0);
+    TRANSPORT_LOG("[Server][UDP-RX] Received: id=%u by='%s' status=%u client=%u end=%u (client end=%u)\n",
+           (unsigned)msg.eventID, msg.handledBy, (unsigned)msg.status,
+           (unsigned)ntohs(sender->sin_port), (unsigned)msg.timestampEnd, (unsigned)clientEnd);
+
+    /* Update DataBase */
+    Db_UpdateEventCompletion(&msg);
+}
+
+
+/**
+ * @brief Routes one event to its shard owner and writes it to the socket.
+ * @param sock - Socket to send from
+ * @param event - Event to send
+ * @param who - Log prefix of the calling stage
+ * 
+ * @attention This function is static and only used within this file.
+ * @return BaseType_t pdPASS on success, pdFAIL otherwise.
+ */
+static BaseType_t ServerSendEvent(int sock, const EmergencyEvent_t *event, const char *who)
+{
+    int client = ServerUDP_RouteEvent(event); // Shard owner on the hash ring
+    if (client < 0) {
+        printf("[Server][%s] No client registered, drop event id=%u\n", who, (unsigned)event->eventID);
+        return pdFAIL;
+    }
+
+    struct sockaddr_in dest = clients[client].addr;
+    ssize_t s = sendto(sock, event, sizeof(*event), 0, (struct sockaddr*)&dest, sizeof(dest));
+    if (s != (ssize_t)sizeof(*event)) { // sendto error
+        printf("[Server][%s] sendto failed: %s\n", who, strerror(errno));
+        return pdFAIL;
+    }
+
+    clients[client].eventsSent++; // Successful send
+    TRANSPORT_LOG("[Server][%s] Sent event id=%u to client=%u\n",
+           who, (unsigned)event->eventID, (unsigned)ntohs(dest.sin_port));
+    return pdPASS;
+}
+
 
 /* Initialize UDP server socket once */
 int ServerUDP_Init(void)
@@ -53,6 +250,129 @@ int ServerUDP_GetSocket(void)
     return serverSock; // Return the server socket descriptor
 }
 
+/* Add a client to the membership */
+int ServerUDP_AddClient(const char *ip, uint16_t port)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        printf("[Server][UDP] Bad client address %s\n", ip);
+        return -1;
+    }
+
+    int index = -1;
+
+    vTaskSuspendAll(); // Keep routing/heartbeat from seeing a half built ring
+    if (ClientFromAddr(&addr) >= 0) {
+        index = ClientFromAddr(&addr); // Already a member
+    } else {
+        for (int c = 0; c < UDP_MAX_CLIENTS; c++) {
+            if (!clients[c].active) {
+                memset(&clients[c], 0, sizeof(clients[c]));
+                clients[c].addr   = addr;
+                clients[c].active = pdTRUE;
+                index = c;
+                ShardRingRebuild();
+                break;
+            }
+        }
+    }
+    (void)xTaskResumeAll();
+
+    if (index < 0) {
+        printf("[Server][UDP] Membership full, client %s:%u not added\n", ip, (unsigned)port);
+    } else {
+        printf("[Server][UDP] Client %d is %s:%u\n", index, ip, (unsigned)port);
+    }
+    return index;
+}
+
+/* Remove a client from the membership */
+int ServerUDP_RemoveClient(const char *ip, uint16_t port)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) return -1;
+
+    vTaskSuspendAll();
+    int index = ClientFromAddr(&addr);
+    if (index >= 0) {
+        clients[index].active = pdFALSE;
+        ShardRingRebuild(); // Only keys owned by the removed client move
+    }
+    (void)xTaskResumeAll();
+
+    if (index >= 0) printf("[Server][UDP] Client %d (%s:%u) removed\n", index, ip, (unsigned)port);
+    return index;
+}
+
+/* Pick the client that owns this event on the hash ring */
+int ServerUDP_RouteEvent(const EmergencyEvent_t *event)
+{
+#if (SHARD_KEY == SHARD_BY_TYPE)
+    uint32_t h = ShardHash(&event->type, sizeof(event->type));
+#else
+    uint32_t h = ShardHash(event->location, strnlen(event->location, sizeof(event->location)));
+#endif
+
+    int client = -1;
+
+    vTaskSuspendAll();
+    if (ringCount > 0) {
+        /* First point clockwise from the key (binary search), wrapping to ring[0] */
+        uint32_t lo = 0, hi = ringCount;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (ring[mid].hash < h) lo = mid + 1;
+            else hi = mid;
+        }
+        client = (int)ring[(lo == ringCount) ? 0 : lo].client;
+    }
+    (void)xTaskResumeAll();
+
+    return client;
+}
+
+/* Published clock offset (client - server) */
+int32_t ServerUDP_GetClockOffset(int client)
+{
+    if (client < 0 || client >= UDP_MAX_CLIENTS) return 0;
+
+    int32_t offset;
+    taskENTER_CRITICAL();
+    offset = clients[client].clockOffset;
+    taskEXIT_CRITICAL();
+    return offset;
+}
+
+/* RTT of the published heartbeat sample */
+uint32_t ServerUDP_GetRtt(int client)
+{
+    if (client < 0 || client >= UDP_MAX_CLIENTS) return 0;
+
+    uint32_t rtt;
+    taskENTER_CRITICAL();
+    rtt = clients[client].clockRtt;
+    taskEXIT_CRITICAL();
+    return rtt;
+}
+
+/* Map client ticks onto server timeline */
+uint32_t ServerUDP_ClientToServerTicks(int client, uint32_t clientTicks)
+{
+    return clientTicks - (uint32_t)ServerUDP_GetClockOffset(client);
+}
+
+/* Fast path - send from the calling task on the server socket */
+BaseType_t ServerUDP_SendEvent(const EmergencyEvent_t *event)
+{
+    return ServerSendEvent(serverSock, event, "UDP-FAST");
+}
+
 /* Send UDP messages from Server Task */
 void vServerUDPTxTask(void *pvParameters)
 {
@@ -65,26 +385,14 @@ void vServerUDPTxTask(void *pvParameters)
         vTaskDelete(NULL);
     }
 
-    /* Define destination address */
-    struct sockaddr_in dest;
-    memset(&dest, 0, sizeof(dest));
-    dest.sin_family = AF_INET;
-    dest.sin_port   = htons(UDP_CLIENT_PORT);
-    inet_pton(AF_INET, UDP_IP_Addr, &dest.sin_addr);
-
     printf("[Server][UDP-TX] Started\n");
 
     /* Main transmission loop */
     for (;;) {
         EmergencyEvent_t event;
 
-        if (xQueueReceive(handle_serverUDPTxQ, &event, portMAX_DELAY) == pdPASS) { // Received from queue only if available
-            ssize_t s = sendto(txSock, &event, sizeof(event), 0, (struct sockaddr*)&dest, sizeof(dest));
-            if (s != (ssize_t)sizeof(event)) { // sendto error
-                printf("[Server][UDP-TX] sendto failed: %s\n", strerror(errno));
-            } else { // Successful send
-                printf("[Server][UDP-TX] Sent event id=%u\n", (unsigned)event.eventID);
-            }
+        if (QosLanes_Receive(&lanes_serverUDPTx, &event, portMAX_DELAY) == pdPASS) { // High lane first - received only if available
+            (void)ServerSendEvent(txSock, &event, "UDP-TX");
         }
     }
 
@@ -108,21 +416,39 @@ void vServerUDPRxTask(void *pvParameters)
 
     /* Main Client to Server loop */
     for (;;) {
-        CompletionMsg_t msg;
+        union { // Datagrams are told apart by size and magic
+            CompletionMsg_t   msg;
+            CompletionBatch_t batch;
+            HeartbeatMsg_t    hb;
+        } rx;
         struct sockaddr_in sender;
         socklen_t senderLen = sizeof(sender);
 
-        ssize_t n = recvfrom(rxSock, &msg, sizeof(msg), 0,
+        ssize_t n = recvfrom(rxSock, &rx, sizeof(rx), 0,
                              (struct sockaddr*)&sender, &senderLen);
+
+        uint32_t rxTick = (uint32_t)xTaskGetTickCount();
+        int client = (n > 0) ? ClientFromAddr(&sender) : -1; // Completions come back from any member
+
+        /* Heartbeat reply - update clock offset estimation */
+        if (n == (ssize_t)sizeof(rx.hb) && rx.hb.magic == HEARTBEAT_MAGIC) {
+            if (client >= 0) HeartbeatOnReply(&clients[client], &rx.hb, rxTick);
+            continue; // Continue to next iteration
+        }
+
+        /* Completion batch - header + count items */
+        if (n >= (ssize_t)offsetof(CompletionBatch_t, items) && rx.batch.magic == COMPLETION_BATCH_MAGIC &&
+            rx.batch.count <= COMPLETION_BATCH_MAX &&
+            n == (ssize_t)(offsetof(CompletionBatch_t, items) + rx.batch.count * sizeof(CompletionMsg_t))) {
+            for (uint32_t i = 0; i < rx.batch.count; i++) {
+                ServerOnCompletion(client, &rx.batch.items[i], &sender);
+            }
+            continue; // Continue to next iteration
+        }
                              
-        /* Check if the received data matches the expected size */
-        if (n == (ssize_t)sizeof(msg)) {
-            (void)xQueueSend(handle_serverUDPRxQ, &msg, 0);
-            printf("[Server][UDP-RX] Received: id=%u by='%s' status=%u\n",
-                   (unsigned)msg.eventID, msg.handledBy, (unsigned)msg.status);
-            
-            /* Update DataBase */
-            Db_UpdateEventCompletion(&msg);
+        /* Single completion - check if the received data matches the expected size */
+        if (n == (ssize_t)sizeof(rx.msg)) {
+            ServerOnCompletion(client, &rx.msg, &sender);
             continue; // Continue to next iteration
         }
 
@@ -150,3 +476,46 @@ void vServerUDPRxTask(void *pvParameters)
 
     vTaskDelete(NULL); // Delete and free resources - Should never reach here
 }
+
+/* Send periodic heartbeat requests to Client */
+void vServerHeartbeatTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    /* Heartbeats leave from the bound server socket so replies reach vServerUDPRxTask */
+    int hbSock = ServerUDP_GetSocket();
+    if (hbSock < 0) {
+        printf("[Server][HB] ERROR: ServerUDP_Init was not called\n");
+        vTaskDelete(NULL);
+    }
+
+    printf("[Server][HB] Started (interval=%ums)\n", (unsigned)HEARTBEAT_INTERVAL_MS);
+
+    uint32_t seq = 0; // Heartbeat sequence number
+    TickType_t lastWake = xTaskGetTickCount();
+
+    /* Main heartbeat loop - one request per member each period */
+    for (;;) {
+        for (int c = 0; c < UDP_MAX_CLIENTS; c++) {
+            if (!clients[c].active) continue;
+            struct sockaddr_in dest = clients[c].addr;
+
+            HeartbeatMsg_t hb;
+            memset(&hb, 0, sizeof(hb));
+            hb.magic = HEARTBEAT_MAGIC;
+            hb.seq   = seq;
+            hb.t1    = (uint32_t)xTaskGetTickCount(); // Taken as late as possible before sendto
+
+            ssize_t s = sendto(hbSock, &hb, sizeof(hb), 0, (struct sockaddr*)&dest, sizeof(dest));
+            if (s != (ssize_t)sizeof(hb)) { // sendto error
+                printf("[Server][HB] sendto client=%u failed: %s\n",
+                       (unsigned)ntohs(dest.sin_port), strerror(errno));
+            }
+        }
+        seq++;
+
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(HEARTBEAT_INTERVAL_MS)); // Fixed period, no drift
+    }
+
+    vTaskDelete(NULL); // Delete and free resources - Should never reach here
+}
@@ -12,45 +12,99 @@
 /* ------Queue implementation------ */
 
 /* Define queue, semaphore and mutex handles and set to NULL */
-QueueHandle_t handle_serverUDPTxQ      = NULL;
+QosLanes_t    lanes_serverUDPTx        = { { NULL, NULL }, NULL, 0 };
 QueueHandle_t handle_serverUDPRxQ      = NULL;
-QueueHandle_t handle_clientUDPRxQ      = NULL;
-QueueHandle_t handle_clientUDPTxQ      = NULL;
+QosLanes_t    lanes_clientUDPRx[DISPATCHER_SHARDS]; // Created by CreateUDPQueues()
 
-QueueHandle_t handle_deptAmbulanceQ    = NULL;
-QueueHandle_t handle_deptPoliceQ       = NULL;
-QueueHandle_t handle_deptFireQ         = NULL;
-QueueHandle_t handle_deptMaintQ        = NULL;
-QueueHandle_t handle_deptElectQ        = NULL;
-QueueHandle_t handle_deptWasteQ        = NULL;
+/* Department registry - all slots start unregistered (queue == NULL) */
+DepartmentDescription_t g_depts[DEPT_REGISTRY_MAX];
 
-SemaphoreHandle_t handleMux_deptAmbulanceQ = NULL;
-SemaphoreHandle_t handleMux_deptPoliceQ    = NULL;
-SemaphoreHandle_t handleMux_deptFireQ      = NULL;
-SemaphoreHandle_t handleMux_deptMaintQ     = NULL;
-SemaphoreHandle_t handleMux_deptElectQ     = NULL;
-SemaphoreHandle_t handleMux_deptWasteQ     = NULL;
 
-SemaphoreHandle_t handleSem_deptAmbulance = NULL;
-SemaphoreHandle_t handleSem_deptPolice    = NULL;
-SemaphoreHandle_t handleSem_deptFire      = NULL;
-SemaphoreHandle_t handleSem_deptMaint     = NULL;
-SemaphoreHandle_t handleSem_deptElect     = NULL;
-SemaphoreHandle_t handleSem_deptWaste     = NULL;
 
+/* ------QoS lanes implementation------ */
+
+/**
+ * @brief Creates every lane with the same length and the pending counting semaphore.
+ * @param lanes - Lanes to create
+ * @param laneLen - Length of each lane
+ * 
+ * @attention This function is static and only used within this file.
+ * @return BaseType_t pdPASS on success, pdFAIL otherwise.
+ */
+static BaseType_t QosLanes_Create(QosLanes_t *lanes, UBaseType_t laneLen)
+{
+    for (UBaseType_t i = 0; i < QOS_LANES; i++) {
+        lanes->lane[i] = xQueueCreate(laneLen, sizeof(EmergencyEvent_t));
+        if (!lanes->lane[i]) return pdFAIL;
+    }
+
+    lanes->pending   = xSemaphoreCreateCounting(laneLen * QOS_LANES, 0);
+    lanes->highBurst = 0;
+
+    return lanes->pending ? pdPASS : pdFAIL;
+}
+
+UBaseType_t QosLaneFromPriority(uint8_t priority)
+{
+    return (priority >= QOS_HIGH_PRIORITY_MIN) ? QOS_LANE_HIGH : QOS_LANE_NORMAL;
+}
+
+BaseType_t QosLanes_Send(QosLanes_t *lanes, const EmergencyEvent_t *event, TickType_t xTicksToWait)
+{
+    if (xQueueSend(lanes->lane[QosLaneFromPriority(event->priority)], event, xTicksToWait) != pdPASS) {
+        return errQUEUE_FULL;
+    }
+
+    xSemaphoreGive(lanes->pending); // Item is already in the lane - a receiver will always find it
+    return pdPASS;
+}
+
+BaseType_t QosLanes_Receive(QosLanes_t *lanes, EmergencyEvent_t *event, TickType_t xTicksToWait)
+{
+    if (xSemaphoreTake(lanes->pending, xTicksToWait) != pdPASS) {
+        return pdFAIL; // Nothing in any lane
+    }
+
+    /* Weighted-strict order: let one normal item through after a long high burst */
+    if (lanes->highBurst >= QOS_HIGH_BURST &&
+        xQueueReceive(lanes->lane[QOS_LANE_NORMAL], event, 0) == pdPASS) {
+        lanes->highBurst = 0;
+        return pdPASS;
+    }
+
+    for (UBaseType_t i = 0; i < QOS_LANES; i++) {
+        if (xQueueReceive(lanes->lane[i], event, 0) == pdPASS) {
+            lanes->highBurst = (i == QOS_LANE_HIGH) ? lanes->highBurst + 1 : 0;
+            return pdPASS;
+        }
+    }
+
+    return pdFAIL; // Should never happen - pending count and lanes are out of sync
+}
+
+UBaseType_t QosLanes_MessagesWaiting(const QosLanes_t *lanes)
+{
+    UBaseType_t n = 0;
+    for (UBaseType_t i = 0; i < QOS_LANES; i++) {
+        n += uxQueueMessagesWaiting(lanes->lane[i]);
+    }
+    return n;
+}
 
 
 /* Function to create all UDP queues */
 BaseType_t CreateUDPQueues(void) 
 {
-    handle_serverUDPTxQ = xQueueCreate(SERVER_UDP_TX_LEN, sizeof(EmergencyEvent_t));
+    BaseType_t serverTxLanes = QosLanes_Create(&lanes_serverUDPTx, SERVER_UDP_TX_LEN);
     handle_serverUDPRxQ = xQueueCreate(SERVER_UDP_RX_LEN, sizeof(CompletionMsg_t));
 
-    handle_clientUDPRxQ = xQueueCreate(CLIENT_UDP_RX_LEN, sizeof(EmergencyEvent_t));
-    handle_clientUDPTxQ = xQueueCreate(CLIENT_UDP_TX_LEN, sizeof(CompletionMsg_t));
+    BaseType_t clientRxLanes = pdPASS;
+    for (UBaseType_t s = 0; s < DISPATCHER_SHARDS && clientRxLanes == pdPASS; s++) {
+        clientRxLanes = QosLanes_Create(&lanes_clientUDPRx[s], CLIENT_UDP_RX_LEN);
+    }
 
     /* Check if all queues were created successfully */
-    if (!handle_serverUDPTxQ || !handle_serverUDPRxQ || !handle_clientUDPRxQ || !handle_clientUDPTxQ) {
+    if (serverTxLanes != pdPASS || !handle_serverUDPRxQ || clientRxLanes != pdPASS) {
         printf("[Shared] ERROR: Failed to create one or more queues\n");
         return pdFAIL;
     }
@@ -59,43 +113,632 @@ BaseType_t CreateUDPQueues(void)
     return pdPASS;
 } /* End of CreateUDPQueues */
 
-/* Function to create all Department queues, mutexes and counting semaphores */
-BaseType_t CreateClientDepartmentQueuesSemaphoresAndMutex(void) 
-{
-    handle_deptAmbulanceQ = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t));
-    handle_deptPoliceQ    = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t));
-    handle_deptFireQ      = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t));
-    handle_deptMaintQ     = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t));
-    handle_deptElectQ     = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t));
-    handle_deptWasteQ     = xQueueCreate(DEPT_Q_LEN, sizeof(EmergencyEvent_t)); 
-
-    handleMux_deptAmbulanceQ = xSemaphoreCreateMutex();
-    handleMux_deptPoliceQ    = xSemaphoreCreateMutex();
-    handleMux_deptFireQ      = xSemaphoreCreateMutex();
-    handleMux_deptMaintQ     = xSemaphoreCreateMutex();
-    handleMux_deptElectQ     = xSemaphoreCreateMutex();
-    handleMux_deptWasteQ     = xSemaphoreCreateMutex();
-
-    handleSem_deptAmbulance = xSemaphoreCreateCounting(AMBULANCE_VEHICLES, AMBULANCE_VEHICLES);
-    handleSem_deptPolice    = xSemaphoreCreateCounting(POLICE_VEHICLES, POLICE_VEHICLES);
-    handleSem_deptFire      = xSemaphoreCreateCounting(FIRE_VEHICLES, FIRE_VEHICLES);
-    handleSem_deptMaint     = xSemaphoreCreateCounting(MAINTENANCE_VEHICLES, MAINTENANCE_VEHICLES);
-    handleSem_deptElect     = xSemaphoreCreateCounting(ELECTRICITY_VEHICLES, ELECTRICITY_VEHICLES);
-    handleSem_deptWaste     = xSemaphoreCreateCounting(WASTE_VEHICLES, WASTE_VEHICLES); 
-
-    /* Check if all queues, mutexes and semaphores were created successfully */
-    if (!handle_deptAmbulanceQ || !handle_deptPoliceQ || !handle_deptFireQ || !handle_deptMaintQ || !handle_deptElectQ || !handle_deptWasteQ ||
-        !handleMux_deptAmbulanceQ || !handleMux_deptPoliceQ || !handleMux_deptFireQ || !handleMux_deptMaintQ || !handleMux_deptElectQ || 
-        !handleMux_deptWasteQ || !handleSem_deptAmbulance || !handleSem_deptPolice || !handleSem_deptFire || !handleSem_deptMaint || 
-        !handleSem_deptElect || !handleSem_deptWaste) 
-    {
-        printf("[Shared] ERROR: Failed to create one or more department queues, semaphores or mutexes\n");
-        return pdFAIL; // return failure if any creation failed
-    }
-
-    printf("[Shared] Department queues, semaphores and mutexes created successfully\n");
-    return pdPASS; // return success if all creations succeeded
+/* ------Department registry implementation------ */
 
-} /* End of CreateClientDepartmentQueuesSemaphoresAndMutex */
+DepartmentDescription_t *Dept_Register(const char *name, EventType_t type, UBaseType_t vehicles)
+{
+    if ((unsigned)type >= DEPT_REGISTRY_MAX || vehicles == 0 || Dept_FromType(type) != NULL) {
+        printf("[Shared] ERROR: Cannot register department %s (type=%d)\n", name, (int)type);
+        return NULL;
+    }
+
+    DepartmentDescription_t *d = &g_depts[type];
+#if AUTOSCALE_ENABLE
+    UBaseType_t minVehicles = vehicles * FLEET_MIN_PCT / 100;
+    UBaseType_t maxVehicles = vehicles * FLEET_MAX_PCT / 100;
+    if (minVehicles == 0) minVehicles = 1;
+    if (maxVehicles < vehicles) maxVehicles = vehicles;
+#else
+    const UBaseType_t minVehicles = vehicles;
+    const UBaseType_t maxVehicles = vehicles;
+#endif
+    PQueueHandle_t    queue = xPQueueCreate(DEPT_Q_LEN, sizeof(DeptJob_t));
+    SemaphoreHandle_t sem   = xSemaphoreCreateCounting(maxVehicles, vehicles);
+    SemaphoreHandle_t spillMutex = xSemaphoreCreateMutex();
+    SemaphoreHandle_t gangMutex  = xSemaphoreCreateMutex();
+    VehicleState_t    *fleet = pvPortMalloc(maxVehicles * sizeof(VehicleState_t));
+    VehicleState_t    **idleStack = pvPortMalloc(maxVehicles * sizeof(VehicleState_t *));
+
+    if (!queue || !sem || !spillMutex || !gangMutex || !fleet || !idleStack) {
+        printf("[Shared] ERROR: Failed to create queue, semaphore, mutex or fleet of department %s\n", name);
+        if (queue) vPQueueDelete(queue);
+        if (sem)   vSemaphoreDelete(sem);
+        if (spillMutex) vSemaphoreDelete(spillMutex);
+        if (gangMutex)  vSemaphoreDelete(gangMutex);
+        vPortFree(fleet);
+        vPortFree(idleStack);
+        return NULL;
+    }
+
+    /* Publish the queue last - Dept_FromType() treats the slot as registered from then on */
+    taskENTER_CRITICAL();
+    d->name         = name;
+    d->type         = type;
+    d->vehicles     = vehicles;
+    d->minVehicles  = minVehicles;
+    d->maxVehicles  = maxVehicles;
+    d->availableSem = sem;
+    d->spillMutex   = spillMutex;
+    d->gangMutex    = gangMutex;
+    d->gangHeld     = 0;
+    d->manager      = NULL; // Set by the manager task when it starts
+    d->signalSem    = NULL; // Set by the supervisor when it starts
+    memset(&d->spill, 0, sizeof(d->spill));
+    memset(&d->load, 0, sizeof(d->load));
+    memset(&d->breakStats, 0, sizeof(d->breakStats));
+    memset(&d->ledger, 0, sizeof(d->ledger));
+    d->ledger.count[DEPT_TOKEN_AVAILABLE] = vehicles; // The semaphore is created holding them
+    d->ledger.total = vehicles;
+    d->fleet        = fleet;
+    memset(fleet, 0, maxVehicles * sizeof(VehicleState_t));
+    for (UBaseType_t i = 0; i < maxVehicles; i++) {
+        fleet[i].dept     = d;
+        fleet[i].index    = i;
+        fleet[i].position = 0; // Start position is set by the vehicle task (or the service clock)
+        fleet[i].idle     = (i < vehicles);
+        fleet[i].retire   = (i >= vehicles); // Spare slots - started by the autoscaler (Vehicle_Activate)
+        fleet[i].parked   = (i >= vehicles);
+        fleet[i].stats.activity = (i < vehicles) ? VEHICLE_IDLE : VEHICLE_RETIRED; // State-time accounting starts at registration
+        fleet[i].stats.since    = xTaskGetTickCount();
+    }
+    d->idleStack    = idleStack;
+    d->idleCount    = 0; // Vehicles push themselves when they start (the service clock pushes them all)
+    d->queue        = queue;
+    taskEXIT_CRITICAL();
+
+    return d;
+}
+
+uint32_t Dept_EventKey(const EmergencyEvent_t *event)
+{
+    uint32_t targetMs;
+    switch (event->priority) {
+        case 3:  targetMs = DEADLINE_HIGH_MS;   break; // High
+        case 2:  targetMs = DEADLINE_MEDIUM_MS; break; // Medium
+        default: targetMs = DEADLINE_LOW_MS;    break; // Low
+    }
+    return (uint32_t)(xTaskGetTickCount() + pdMS_TO_TICKS(targetMs));
+}
+
+uint32_t Dept_EventExpiry(const EmergencyEvent_t *event)
+{
+#if EVENT_TTL_ENABLE
+    uint32_t ttlMs;
+    switch (event->priority) {
+        case 3:  ttlMs = TTL_HIGH_MS;   break; // High
+        case 2:  ttlMs = TTL_MEDIUM_MS; break; // Medium
+        default: ttlMs = TTL_LOW_MS;    break; // Low
+    }
+    if (ttlMs == 0) return 0;
+
+    const uint32_t expiresAt = (uint32_t)(xTaskGetTickCount() + pdMS_TO_TICKS(ttlMs));
+    return expiresAt ? expiresAt : 1; // 0 is reserved for "never"
+#else
+    (void)event;
+    return 0;
+#endif
+}
+
+UBaseType_t Dept_EventUnits(const DepartmentDescription_t *d, const EmergencyEvent_t *event)
+{
+    if (event->units <= 1) return 1;
+    return (event->units > d->vehicles) ? d->vehicles : event->units; // A gang never needs more than the whole fleet
+}
+
+/**
+ * @brief Records a transition of vehicle tokens in the ledger and checks its invariants.
+ * @param d - Department
+ * @param from - State the tokens leave
+ * @param to - State the tokens enter
+ * @param units - Tokens moved
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void DeptLedgerMove(DepartmentDescription_t *d, DeptTokenState_t from, DeptTokenState_t to, UBaseType_t units)
+{
+    DeptLedger_t *l = &d->ledger;
+
+    taskENTER_CRITICAL();
+    configASSERT(l->count[from] >= units); // A token given back twice, or never taken
+    l->count[from] -= units;
+    l->count[to]   += units;
+    configASSERT(l->count[DEPT_TOKEN_AVAILABLE] + l->count[DEPT_TOKEN_BUSY] + l->count[DEPT_TOKEN_BREAK] == l->total);
+    taskEXIT_CRITICAL();
+}
 
+/**
+ * @brief Puts vehicle tokens back into the semaphore - ledger first, so the semaphore never holds more than it counts.
+ * @param d - Department
+ * @param from - State the tokens leave
+ * @param units - Tokens given back
+ * 
+ * @attention This function is static and only used within this file.
+ */
+static void DeptGive(DepartmentDescription_t *d, DeptTokenState_t from, UBaseType_t units)
+{
+    if (units == 0) return;
+
+    vTaskSuspendAll(); // Ledger and semaphore change together for every other task
+    DeptLedgerMove(d, from, DEPT_TOKEN_AVAILABLE, units);
+    while (units-- > 0) {
+        const BaseType_t given = xSemaphoreGive(d->availableSem);
+        configASSERT(given == pdPASS); // Full semaphore - a token that does not exist
+        (void)given;
+    }
+    configASSERT(uxSemaphoreGetCount(d->availableSem) <= d->ledger.count[DEPT_TOKEN_AVAILABLE]);
+    (void)xTaskResumeAll();
+}
+
+/**
+ * @brief Takes vehicle tokens out of the semaphore into a held state - all or nothing, through the reservation gate.
+ * @param d - Department
+ * @param units - Tokens to take
+ * @param xTicksToWait - Max time to wait for the gate and the tokens (0 = only if the gate is free and all tokens are)
+ * @param to - State the tokens enter (DEPT_TOKEN_BUSY or DEPT_TOKEN_BREAK)
+ * 
+ * @attention This function is static and only used within this file.
+ * @return BaseType_t pdPASS if all tokens were taken, pdFAIL on timeout (none are held then).
+ */
+static BaseType_t DeptTake(DepartmentDescription_t *d, UBaseType_t units, TickType_t xTicksToWait, DeptTokenState_t to)
+{
+    TimeOut_t timeOut;
+    vTaskSetTimeOutState(&timeOut);
+
+    /* Gate - FIFO among waiting vehicles of equal priority */
+    if (xSemaphoreTake(d->gangMutex, xTicksToWait) != pdPASS) return pdFAIL;
+
+    if (xTicksToWait == 0 && uxSemaphoreGetCount(d->availableSem) < units) {
+        xSemaphoreGive(d->gangMutex);
+        return pdFAIL; // Not all free now - do not take and give back tokens for nothing
+    }
+
+    /* Collect the tokens - only the gate holder ever holds part of a reservation */
+    UBaseType_t taken = 0;
+    while (taken < units) {
+        (void)xTaskCheckForTimeOut(&timeOut, &xTicksToWait); // Time left after the gate and the tokens so far (0 = try only)
+        if (xSemaphoreTake(d->availableSem, xTicksToWait) != pdPASS) break;
+        DeptLedgerMove(d, DEPT_TOKEN_AVAILABLE, to, 1);
+        taken++;
+    }
+
+    if (taken < units) DeptGive(d, to, taken); // Timed out - all or nothing
+
+    xSemaphoreGive(d->gangMutex);
+    return (taken == units) ? pdPASS : pdFAIL;
+}
+
+BaseType_t Dept_Reserve(DepartmentDescription_t *d, UBaseType_t units, TickType_t xTicksToWait)
+{
+    return DeptTake(d, units, xTicksToWait, DEPT_TOKEN_BUSY);
+}
+
+BaseType_t Dept_ReserveHold(DepartmentDescription_t *d, UBaseType_t units)
+{
+    BaseType_t ret = pdFAIL;
+
+    (void)xSemaphoreTake(d->gangMutex, portMAX_DELAY); // Gate holders never block in handoff modes
+
+    while (d->gangHeld < units && xSemaphoreTake(d->availableSem, 0) == pdPASS) {
+        DeptLedgerMove(d, DEPT_TOKEN_AVAILABLE, DEPT_TOKEN_BUSY, 1);
+        d->gangHeld++;
+    }
+
+    if (d->gangHeld >= units) {
+        DeptGive(d, DEPT_TOKEN_BUSY, d->gangHeld - units); // The head changed to a smaller incident (or is gone)
+        d->gangHeld = 0;
+        ret = pdPASS;
+    }
+
+    xSemaphoreGive(d->gangMutex);
+    return ret;
+}
+
+void Dept_Release(DepartmentDescription_t *d, UBaseType_t units)
+{
+    DeptGive(d, DEPT_TOKEN_BUSY, units);
+}
+
+BaseType_t Dept_BreakStart(DepartmentDescription_t *d)
+{
+    return DeptTake(d, 1, 0, DEPT_TOKEN_BREAK); // Through the gate - never a token a gang reservation is collecting
+}
+
+void Dept_BreakEnd(DepartmentDescription_t *d, UBaseType_t units)
+{
+    DeptGive(d, DEPT_TOKEN_BREAK, units);
+}
+
+void Dept_FleetGrow(DepartmentDescription_t *d)
+{
+    taskENTER_CRITICAL();
+    d->ledger.total++; // Created held, so the give below records it as any other token coming back
+    d->ledger.count[DEPT_TOKEN_BUSY]++;
+    taskEXIT_CRITICAL();
+
+    DeptGive(d, DEPT_TOKEN_BUSY, 1);
+}
+
+BaseType_t Dept_FleetShrink(DepartmentDescription_t *d, BaseType_t fromBreak)
+{
+    const DeptTokenState_t from = fromBreak ? DEPT_TOKEN_BREAK : DEPT_TOKEN_BUSY;
+
+    if (!fromBreak && DeptTake(d, 1, 0, DEPT_TOKEN_BUSY) != pdPASS) {
+        return pdFAIL; // No free token - every vehicle is busy or on break
+    }
+
+    taskENTER_CRITICAL();
+    configASSERT(d->ledger.count[from] > 0);
+    d->ledger.count[from]--;
+    d->ledger.total--;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+UBaseType_t Dept_Ledger(const DepartmentDescription_t *d, DeptLedger_t *out)
+{
+    vTaskSuspendAll(); // Ledger and semaphore count of the same instant
+    *out = d->ledger;
+    const UBaseType_t inSemaphore = (UBaseType_t)uxSemaphoreGetCount(d->availableSem);
+    (void)xTaskResumeAll();
+
+    return inSemaphore + out->count[DEPT_TOKEN_BUSY] + out->count[DEPT_TOKEN_BREAK];
+}
+
+void Dept_OnServiceStart(DepartmentDescription_t *d, const DeptJob_t *job, uint32_t deadline)
+{
+    if (job->remainingMs != 0) return; // Preempted job resumed - counted when it first started
+    const EmergencyEvent_t *event = &job->event;
+
+    const int32_t lateTicks = (int32_t)(xTaskGetTickCount() - deadline);
+
+    taskENTER_CRITICAL();
+    d->served++;
+    if (lateTicks > 0) {
+        d->deadlineMisses++;
+        if ((uint32_t)lateTicks > d->maxLateTicks) d->maxLateTicks = (uint32_t)lateTicks;
+    }
+    taskEXIT_CRITICAL();
 
+    if (lateTicks > 0) {
+        printf("[Client][%s] DEADLINE MISS Dept=%s event id=%u prio=%u late=%ums (misses=%u/%u)\n",
+               pcTaskGetName(NULL), d->name, (unsigned)event->eventID, (unsigned)event->priority,
+               (unsigned)(lateTicks * portTICK_PERIOD_MS), (unsigned)d->deadlineMisses, (unsigned)d->served);
+    }
+}
+
+/**
+ * @brief One EWMA step - the first sample seeds the estimate.
+ * @attention This function is static and only used within this file.
+ */
+static uint32_t LoadEwma(uint32_t estimate, uint32_t sample)
+{
+    if (estimate == 0) return sample ? sample : 1; // 0 is reserved for "no estimate"
+    return (uint32_t)((int32_t)estimate + ((int32_t)sample - (int32_t)estimate) / DEPT_LOAD_EWMA_DIV);
+}
+
+void Dept_OnArrival(DepartmentDescription_t *d)
+{
+    const TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    if (d->load.lastArrival != 0) {
+        d->load.arrivalMs = LoadEwma(d->load.arrivalMs, (uint32_t)((now - d->load.lastArrival) * portTICK_PERIOD_MS));
+    }
+    d->load.lastArrival = now ? now : 1;
+    taskEXIT_CRITICAL();
+}
+
+void Dept_OnServiceEnd(DepartmentDescription_t *d, uint32_t serviceMs)
+{
+    taskENTER_CRITICAL();
+    d->load.serviceMs = LoadEwma(d->load.serviceMs, serviceMs);
+    taskEXIT_CRITICAL();
+}
+
+void Dept_LoadEstimate(const DepartmentDescription_t *d, uint32_t *arrivalMs, uint32_t *serviceMs)
+{
+    taskENTER_CRITICAL();
+    const TickType_t last = d->load.lastArrival;
+    *arrivalMs = d->load.arrivalMs;
+    *serviceMs = d->load.serviceMs;
+    taskEXIT_CRITICAL();
+
+    const uint32_t quietMs = (uint32_t)((xTaskGetTickCount() - last) * portTICK_PERIOD_MS);
+    if (*arrivalMs != 0 && quietMs > *arrivalMs) *arrivalMs = quietMs; // Decay while no event arrives
+}
+
+/* ------Department spill store implementation------ */
+
+/**
+ * @brief Returns pdTRUE if spill item a is more urgent than item b (smaller key, then spilled earlier).
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t SpillMoreUrgent(const DeptSpillItem_t *a, const DeptSpillItem_t *b)
+{
+    if (a->key != b->key) return ((int32_t)(a->key - b->key) < 0) ? pdTRUE : pdFALSE; // Wrap-safe (tick keys)
+    return ((int32_t)(a->seq - b->seq) < 0) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * @brief Pushes a job into the spill store, growing it if needed.
+ * @attention Called with spillMutex held. This function is static and only used within this file.
+ * @return BaseType_t pdPASS on success, pdFAIL at DEPT_SPILL_CAP or if the store could not grow.
+ */
+static BaseType_t SpillPush(DeptSpill_t *sp, const DeptJob_t *job, uint32_t key)
+{
+    if (sp->count >= DEPT_SPILL_CAP) return pdFAIL;
+
+    if (sp->count == sp->capacity) {
+        UBaseType_t newCap = sp->capacity ? sp->capacity * 2 : DEPT_SPILL_CHUNK;
+        if (newCap > DEPT_SPILL_CAP) newCap = DEPT_SPILL_CAP;
+
+        DeptSpillItem_t *items = pvPortMalloc(newCap * sizeof(DeptSpillItem_t));
+        if (items == NULL) return pdFAIL;
+        if (sp->items) {
+            memcpy(items, sp->items, sp->count * sizeof(DeptSpillItem_t));
+            vPortFree(sp->items);
+        }
+        sp->items = items;
+        sp->capacity = newCap;
+    }
+
+    /* Sift up */
+    DeptSpillItem_t item = { key, sp->nextSeq++, *job };
+    UBaseType_t pos = sp->count++;
+    while (pos > 0) {
+        UBaseType_t parent = (pos - 1) / 2;
+        if (!SpillMoreUrgent(&item, &sp->items[parent])) break;
+        sp->items[pos] = sp->items[parent];
+        pos = parent;
+    }
+    sp->items[pos] = item;
+
+    sp->spilled++;
+    if (sp->count > sp->highWater) sp->highWater = sp->count;
+    return pdPASS;
+}
+
+/**
+ * @brief Removes the item at pos from the spill store, and frees the store once it is drained.
+ * @attention Called with spillMutex held and pos < count. This function is static and only used within this file.
+ */
+static void SpillRemoveAt(DeptSpill_t *sp, UBaseType_t pos, DeptSpillItem_t *out)
+{
+    *out = sp->items[pos];
+
+    DeptSpillItem_t last = sp->items[--sp->count];
+    if (pos < sp->count) {
+        /* Fill the hole with the last item - sift up, then down */
+        while (pos > 0 && SpillMoreUrgent(&last, &sp->items[(pos - 1) / 2])) {
+            sp->items[pos] = sp->items[(pos - 1) / 2];
+            pos = (pos - 1) / 2;
+        }
+        for (;;) {
+            UBaseType_t child = 2 * pos + 1;
+            if (child >= sp->count) break;
+            if (child + 1 < sp->count && SpillMoreUrgent(&sp->items[child + 1], &sp->items[child])) child++;
+            if (!SpillMoreUrgent(&sp->items[child], &last)) break;
+            sp->items[pos] = sp->items[child];
+            pos = child;
+        }
+        sp->items[pos] = last;
+    }
+
+    if (sp->count == 0) { // Elastic - give the memory back after a burst
+        vPortFree(sp->items);
+        sp->items = NULL;
+        sp->capacity = 0;
+    }
+}
+
+/**
+ * @brief Moves spilled events into the queue while it has space.
+ * @attention Called with spillMutex held - every send into the queue holds it, so the free space cannot be taken.
+ *            This function is static and only used within this file.
+ */
+static void SpillRefillLocked(DepartmentDescription_t *d)
+{
+    while (d->spill.count > 0 && uxPQueueSpacesAvailable(d->queue) > 0) {
+        DeptSpillItem_t item;
+        SpillRemoveAt(&d->spill, 0, &item);
+        (void)xPQueueSend(d->queue, &item.job, item.key, 0);
+    }
+}
+
+/**
+ * @brief Adds a job with a given key to the department backlog - see Dept_Enqueue().
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t DeptEnqueueKey(DepartmentDescription_t *d, const DeptJob_t *job, uint32_t key,
+                                 EmergencyEvent_t *rejected)
+{
+    BaseType_t ret = pdPASS;
+
+    xSemaphoreTake(d->spillMutex, portMAX_DELAY);
+
+    SpillRefillLocked(d); // Older spilled events first - after this either the spill is empty or the queue is full
+
+    if (xPQueueSend(d->queue, job, key, 0) != pdPASS) {
+        /* Queue full - spill the less urgent of the new job and the least urgent queued job */
+        DeptJob_t lowest;
+        uint32_t lowestKey;
+        const DeptJob_t *toSpill = job;
+        uint32_t toSpillKey = key;
+
+        if (xPQueueRemoveLowest(d->queue, &lowest, &lowestKey) == pdPASS) {
+            if ((int32_t)(key - lowestKey) < 0) {
+                (void)xPQueueSend(d->queue, job, key, 0); // Space is guaranteed - we hold spillMutex
+                toSpill = &lowest;
+                toSpillKey = lowestKey; // Keeps its original deadline
+            } else {
+                (void)xPQueueSend(d->queue, &lowest, lowestKey, 0);
+            }
+        }
+
+        if (SpillPush(&d->spill, toSpill, toSpillKey) != pdPASS) {
+            d->spill.failed++;
+            *rejected = toSpill->event;
+            ret = pdFAIL;
+        }
+    }
+
+    xSemaphoreGive(d->spillMutex);
+    return ret;
+}
+
+BaseType_t Dept_Enqueue(DepartmentDescription_t *d, const EmergencyEvent_t *event, uint32_t helpers, EmergencyEvent_t *rejected)
+{
+    const DeptJob_t job = { *event, 0, Dept_EventExpiry(event), helpers }; // Not started yet - the TTL runs from now
+    return DeptEnqueueKey(d, &job, Dept_EventKey(event), rejected);
+}
+
+BaseType_t Dept_Requeue(DepartmentDescription_t *d, const DeptJob_t *job, uint32_t key, EmergencyEvent_t *rejected)
+{
+    return DeptEnqueueKey(d, job, key, rejected);
+}
+
+void Dept_Refill(DepartmentDescription_t *d)
+{
+    if (d->spill.count == 0) return; // Cheap check - a stale zero is caught by the next refill
+
+    xSemaphoreTake(d->spillMutex, portMAX_DELAY);
+    SpillRefillLocked(d);
+    xSemaphoreGive(d->spillMutex);
+}
+
+BaseType_t Dept_RemoveLowest(DepartmentDescription_t *d, EmergencyEvent_t *event)
+{
+    BaseType_t ret;
+
+    xSemaphoreTake(d->spillMutex, portMAX_DELAY);
+
+    if (d->spill.count > 0) {
+        /* Least urgent spilled event is one of the heap leaves - O(n) scan, overload path only */
+        DeptSpill_t *sp = &d->spill;
+        UBaseType_t worst = sp->count / 2;
+        for (UBaseType_t i = worst + 1; i < sp->count; i++) {
+            if (SpillMoreUrgent(&sp->items[worst], &sp->items[i])) worst = i;
+        }
+
+        DeptSpillItem_t item;
+        SpillRemoveAt(sp, worst, &item);
+        *event = item.job.event;
+        ret = pdPASS;
+    } else {
+        DeptJob_t job;
+        ret = xPQueueRemoveLowest(d->queue, &job, NULL);
+        if (ret == pdPASS) *event = job.event;
+    }
+
+    xSemaphoreGive(d->spillMutex);
+    return ret;
+}
+
+/**
+ * @brief xPQueueReceiveIf predicate - pdTRUE if the job is past its TTL (context = pointer to the current tick).
+ * @attention This function is static and only used within this file.
+ */
+static BaseType_t IsExpired(const void *pvItem, void *pvContext)
+{
+    return Dept_EventExpired((const DeptJob_t *)pvItem, *(const TickType_t *)pvContext);
+}
+
+BaseType_t Dept_TakeExpired(DepartmentDescription_t *d, EmergencyEvent_t *event)
+{
+    TickType_t now = xTaskGetTickCount();
+    BaseType_t ret = pdFAIL;
+    DeptJob_t job;
+
+    xSemaphoreTake(d->spillMutex, portMAX_DELAY);
+
+    DeptSpill_t *sp = &d->spill;
+    for (UBaseType_t i = 0; i < sp->count; i++) {
+        if (Dept_EventExpired(&sp->items[i].job, now)) {
+            DeptSpillItem_t item;
+            SpillRemoveAt(sp, i, &item);
+            *event = item.job.event;
+            ret = pdPASS;
+            break;
+        }
+    }
+
+    if (ret != pdPASS && xPQueueReceiveIf(d->queue, &job, NULL, IsExpired, &now) == pdPASS) {
+        *event = job.event;
+        SpillRefillLocked(d); // Free slot in the queue - pull the most urgent spilled event back in
+        ret = pdPASS;
+    }
+
+    if (ret == pdPASS) {
+        taskENTER_CRITICAL(); // Vehicles count the events they dequeue past their TTL without spillMutex
+        d->expired++;
+        taskEXIT_CRITICAL();
+    }
+
+    xSemaphoreGive(d->spillMutex);
+    return ret;
+}
+
+BaseType_t Dept_TakeIf(DepartmentDescription_t *d, PQueuePredicate_t xPredicate, void *pvContext, DeptJob_t *job, uint32_t *key)
+{
+    BaseType_t ret = pdFAIL;
+
+    xSemaphoreTake(d->spillMutex, portMAX_DELAY);
+
+    if (xPQueueReceiveIf(d->queue, job, key, xPredicate, pvContext) == pdPASS) {
+        SpillRefillLocked(d); // Free slot in the queue - pull the most urgent spilled event back in
+        ret = pdPASS;
+    } else {
+        /* Nothing queued is accepted - most urgent accepted spilled job, O(n) scan outside any critical section */
+        DeptSpill_t *sp = &d->spill;
+        UBaseType_t best = sp->count;
+        for (UBaseType_t i = 0; i < sp->count; i++) {
+            if ((best == sp->count || SpillMoreUrgent(&sp->items[i], &sp->items[best])) &&
+                xPredicate(&sp->items[i].job, pvContext)) {
+                best = i;
+            }
+        }
+
+        if (best < sp->count) {
+            DeptSpillItem_t item;
+            SpillRemoveAt(sp, best, &item);
+            *job = item.job;
+            if (key) *key = item.key;
+            ret = pdPASS;
+        }
+    }
+
+    xSemaphoreGive(d->spillMutex);
+    return ret;
+}
+
+UBaseType_t Dept_Backlog(const DepartmentDescription_t *d)
+{
+    return uxPQueueMessagesWaiting(d->queue) + d->spill.count;
+}
+
+void Dept_SignalManager(DepartmentDescription_t *d, uint32_t bits)
+{
+    SemaphoreHandle_t signalSem = d->signalSem;
+    if (signalSem != NULL) {
+        (void)xSemaphoreGive(signalSem); // Supervisor queue set - already given = already pending
+        return;
+    }
+
+    TaskHandle_t manager = d->manager;
+    if (manager != NULL) (void)xTaskNotify(manager, bits, eSetBits);
+}
+
+/* Function to register all Departments of the descriptor list (queues and counting semaphores) */
+BaseType_t CreateClientDepartmentQueuesSemaphoresAndMutex(const DepartmentDescription_t *list, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (Dept_Register(list[i].name, list[i].type, list[i].vehicles) == NULL) {
+            printf("[Shared] ERROR: Failed to create one or more department queues or semaphores\n");
+            return pdFAIL; // return failure if any creation failed
+        }
+    }
+
+    printf("[Shared] Department queues and semaphores created successfully (%u departments)\n", (unsigned)count);
+    return pdPASS; // return success if all creations succeeded
+
+} /* End of CreateClientDepartmentQueuesSemaphoresAndMutex */
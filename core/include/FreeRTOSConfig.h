@@ -58,6 +58,7 @@
 #define configUSE_ALTERNATIVE_API                  0
 #define configUSE_QUEUE_SETS                       1
 #define configUSE_TASK_NOTIFICATIONS               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      2 /* index 1 = vehicle handoff mailbox (VEHICLE_MAILBOX_INDEX) */
 #define configSUPPORT_STATIC_ALLOCATION            1
 
 /* Software timer related configuration options.  The maximum possible task
@@ -1,10 +1,22 @@
 /**
  * @file main.c
  * @authors Aviel Yitzhak (Aviel2488@gmail.com)
- * @brief Project entry point: initializes system and starts only the Server task.
+ * @brief Project entry point: initializes system and starts the Server and/or Client tasks.
+ *
+ *        Usage: posix_demo [all|server|client] [port ...]
+ *          all  [port ...]  - Server + Client in one process (default). Extra ports are added as more clients.
+ *          server [port ...] - Server only, fanning events out to the clients on the given ports
+ *                              (default UDP_CLIENT_PORT).
+ *          client [port]     - Client only (one regional dispatch center) listening on port (default UDP_CLIENT_PORT).
+ *
+ *        Build with "make TRANSPORT_BENCH=1" for the transport-only benchmark (see Server_Bench.h).
+ *        Build with "make FAST_PATH=1" to skip the UDP-TX and UDP-RX/dispatcher queue hops (can be combined with the benchmark).
+ *        Build with "make SERVICE_CLOCK=1" to simulate the vehicles without a task per vehicle (scale fleets with FLEET_SCALE=n).
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "init.h"
 #include "FreeRTOS.h"
@@ -12,9 +24,11 @@
 
 #include "Server/Server_Task.h"
 #include "Server/Server_UDP.h"
+#include "Server/Server_Bench.h"
 #include "Client/Client_UDP.h"
 #include "Client/DispatcherAndMangerDepartment_Task.h"
 #include "Client/Vehicle_Task.h"
+#include "Client/Location.h"
 
 // Priorities: 
 #define HIGH_PRIORITY      4
@@ -24,36 +38,76 @@
 
 // Task Handles:
 TaskHandle_t xServerEventGenTaskHandle            = NULL; // Server Event Generator Task Handle
-TaskHandle_t xClientDispatcherTaskHandle          = NULL; // Client Dispatcher Task Handle
-TaskHandle_t xClientManagerTaskHandle[6]          = {NULL}; // Client Manager Task Handle array for 6 departments
+TaskHandle_t xClientDispatcherTaskHandle[DISPATCHER_SHARDS] = {NULL}; // Client Dispatcher Task Handle array, indexed by shard
+TaskHandle_t xClientManagerTaskHandle[DEPT_REGISTRY_MAX] = {NULL}; // Client Manager Task Handle array, indexed by department type
 
-TaskHandle_t xClientAmbulanceTaskHandle[AMBULANCE_VEHICLES]            = {NULL}; // Client Ambulance Task Handle array
-TaskHandle_t xClientPoliceTaskHandle[POLICE_VEHICLES]                  = {NULL}; // Client Police Task Handle array
-TaskHandle_t xClientFireTaskHandle[FIRE_VEHICLES]                      = {NULL}; // Client Fire Task Handle array
-TaskHandle_t xClientMaintenanceTaskHandle[MAINTENANCE_VEHICLES]        = {NULL}; // Client Maintenance Task Handle array
-TaskHandle_t xClientWasteTaskHandle[WASTE_VEHICLES]                    = {NULL}; // Client Waste Collection Task Handle array
-TaskHandle_t xClientElectricityTaskHandle[ELECTRICITY_VEHICLES]        = {NULL}; // Client Electricity Task Handle array
-
-/* Department Description Array - Helper array */
+/* Department descriptor list - the department registry (g_depts) is built from it at startup */
 DepartmentDescription_t deptDesc[] = {
-    { "AMBULANCE",   EVENT_AMBULANCE,        NULL, NULL, NULL },
-    { "POLICE",      EVENT_POLICE,           NULL, NULL, NULL },
-    { "FIRE",        EVENT_FIRE_DEPARTMENT,  NULL, NULL, NULL },
-    { "MAINT",       EVENT_MAINTENANCE,      NULL, NULL, NULL },
-    { "WASTE",       EVENT_WASTE_COLLECTION, NULL, NULL, NULL },
-    { "ELECTRICITY", EVENT_ELECTRICITY,      NULL, NULL, NULL },
+    { "AMBULANCE",   EVENT_AMBULANCE,        AMBULANCE_VEHICLES,   NULL, NULL },
+    { "POLICE",      EVENT_POLICE,           POLICE_VEHICLES,      NULL, NULL },
+    { "FIRE",        EVENT_FIRE_DEPARTMENT,  FIRE_VEHICLES,        NULL, NULL },
+    { "MAINT",       EVENT_MAINTENANCE,      MAINTENANCE_VEHICLES, NULL, NULL },
+    { "WASTE",       EVENT_WASTE_COLLECTION, WASTE_VEHICLES,       NULL, NULL },
+    { "ELECTRICITY", EVENT_ELECTRICITY,      ELECTRICITY_VEHICLES, NULL, NULL },
 };
 
 const size_t numDepts = sizeof(deptDesc) / sizeof(deptDesc[0]);
 
-int main(void)
+/* Process roles - Server and Client halves can run in one process or in separate ones */
+typedef enum {
+    ROLE_ALL = 0,
+    ROLE_SERVER,
+    ROLE_CLIENT
+} ProcessRole_t;
+
+static int StartServerTasks(void);
+static int StartClientTasks(void);
+
+int main(int argc, char **argv)
 {
     printf("[MAIN] Start Main program\n--------------------------------\n");
 
+    /* Parse process role and ports */
+    ProcessRole_t role = ROLE_ALL;
+    int argi = 1;
+    if (argc > 1) {
+        if      (strcmp(argv[1], "all") == 0)    { role = ROLE_ALL;    argi = 2; }
+        else if (strcmp(argv[1], "server") == 0) { role = ROLE_SERVER; argi = 2; }
+        else if (strcmp(argv[1], "client") == 0) { role = ROLE_CLIENT; argi = 2; }
+    }
+    const int runServer = (role != ROLE_CLIENT);
+    const int runClient = (role != ROLE_SERVER);
+
+    uint16_t clientPort = UDP_CLIENT_PORT; // Port of the in-process client
+    if (role == ROLE_CLIENT && argi < argc) {
+        clientPort = (uint16_t)atoi(argv[argi]);
+    }
+
     /* Initialize all components */
     init_main(); // System Initialization
-    ServerUDP_Init(); // Initialize Server UDP
-    ClientUDP_Init(); // Initialize Client UDP
+
+    if (runServer) {
+        if (ServerUDP_Init() != 0) { // Initialize Server UDP
+            printf("[MAIN] Server UDP init failed\n");
+            return -11;
+        }
+
+        /* Client membership: in-process client first, then every port given on the command line */
+        if (role == ROLE_ALL) {
+            (void)ServerUDP_AddClient(UDP_IP_Addr, clientPort);
+        }
+        for (int i = argi; i < argc; i++) {
+            (void)ServerUDP_AddClient(UDP_IP_Addr, (uint16_t)atoi(argv[i]));
+        }
+        if (role == ROLE_SERVER && argi >= argc) {
+            (void)ServerUDP_AddClient(UDP_IP_Addr, UDP_CLIENT_PORT);
+        }
+    }
+
+    if (runClient && ClientUDP_Init(clientPort) != 0) { // Initialize Client UDP
+        printf("[MAIN] Client UDP init failed\n");
+        return -12;
+    }
 
 
 
@@ -65,24 +119,49 @@ int main(void)
         return -31;
     }
 
-    BaseType_t Dept_QueuesSemaphoresAndMutex_Check = CreateClientDepartmentQueuesSemaphoresAndMutex(); // Client Department queues and mutexes
-    if (Dept_QueuesSemaphoresAndMutex_Check != pdPASS) {
-    printf("[MAIN] Failed to create client department queues\n");
-    return -32;
+    if (runClient && !TRANSPORT_BENCH) {
+        BaseType_t Dept_QueuesSemaphoresAndMutex_Check = CreateClientDepartmentQueuesSemaphoresAndMutex(deptDesc, numDepts); // Client Department registry
+        if (Dept_QueuesSemaphoresAndMutex_Check != pdPASS) {
+        printf("[MAIN] Failed to create client department queues\n");
+        return -32;
+        }
+
+        ClientDeptManager_Init(); // Initialize Client Department Manager
+        Location_Init(); // Precompute travel times for nearest vehicle dispatch
     }
 
     printf("[MAIN] Queues, Semaphores and Mutexes created successfully\n");
 
-    ClientDeptManager_Init(deptDesc); // Initialize Client Department Manager
-
     printf("[MAIN] System initialized\n");
 
     
     /* --------Tasks Creation---------- */
 
-    /* Create UDP tasks */
     printf("[MAIN] Starting Tasks creations ...\n");
 
+    int taskCheck = 0;
+    if (runServer && (taskCheck = StartServerTasks()) != 0) return taskCheck;
+    if (runClient && (taskCheck = StartClientTasks()) != 0) return taskCheck;
+
+
+    /* Start Scheduler */
+    printf("\n[MAIN] Starting scheduler\n--------------------------------\n");
+    vTaskStartScheduler();
+
+
+    /* Should never reach here! - Print & Endless Loop */
+    printf("\n\n[MAIN] Scheduler returned - Unexpected Error\n");
+    while (1) {} // Endless loop
+    
+    return 100; // Return 100 on unexpected exit
+}
+
+/* Create the Server side tasks: UDP TX/RX, heartbeat and event generator */
+static int StartServerTasks(void)
+{
+    /* Create UDP tasks */
+
+#if !FAST_PATH // Fast path - the generator writes to the socket itself
     if ((xTaskCreate( vServerUDPTxTask, "Server_UDP_Tx", configMINIMAL_STACK_SIZE,
                      NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
     { 
@@ -90,6 +169,7 @@ int main(void)
         return -21;
     }
     else { printf("[MAIN] xTaskCreate(ServerUDP_Tx_Task) Successful\n"); } // Successful creation of Server UDP TX Task
+#endif
 
     if ((xTaskCreate( vServerUDPRxTask, "Server_UDP_Rx", configMINIMAL_STACK_SIZE,
                      NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
@@ -99,26 +179,23 @@ int main(void)
     }
     else { printf("[MAIN] xTaskCreate(ServerUDP_Rx_Task) Successful\n"); } // Successful creation of Server UDP RX Task
 
-    if ((xTaskCreate( vClientUDPTxTask, "Client_UDP_Tx", configMINIMAL_STACK_SIZE,
+    if ((xTaskCreate( vServerHeartbeatTask, "Server_UDP_HB", configMINIMAL_STACK_SIZE,
                      NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
     { 
-        printf("[MAIN] xTaskCreate(ClientUDP_Tx_Task) Failed!\n");
-        return -23;
+        printf("[MAIN] xTaskCreate(ServerUDP_HB_Task) Failed!\n");
+        return -25;
     }
-    else { printf("[MAIN] xTaskCreate(ClientUDP_TxTask) Successful\n"); } // Successful creation of Client UDP TX Task
-
-    if ((xTaskCreate( vClientUDPRxTask, "Client_UDP_Rx", configMINIMAL_STACK_SIZE,
-                     NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
-    { 
-        printf("[MAIN] xTaskCreate(ClientUDP_Rx_Task) Failed!\n");
-        return -24;
-    }
-    else { printf("[MAIN] xTaskCreate(ClientUDP_RxTask) Successful\n"); } // Successful creation of Client UDP RX Task
+    else { printf("[MAIN] xTaskCreate(ServerUDP_HB_Task) Successful\n"); } // Successful creation of Server UDP Heartbeat Task
 
    
-    /* Create Server Event Generator Task */
+    /* Create Server Event Generator Task (benchmark generator in transport benchmark mode) */
+#if TRANSPORT_BENCH
+    if ((xTaskCreate( Task_BenchGenerator, "Server_Bench_Gen",configMINIMAL_STACK_SIZE, 
+                     NULL, HIGH_PRIORITY, &xServerEventGenTaskHandle) != pdPASS))
+#else
     if ((xTaskCreate( Task_EventGenerator, "Server_Event_Gen",configMINIMAL_STACK_SIZE, 
                      NULL, HIGH_PRIORITY, &xServerEventGenTaskHandle) != pdPASS))
+#endif
     {
         printf("[MAIN] xTaskCreate(ServerTask) Failed!\n");
         return -26;
@@ -126,133 +203,125 @@ int main(void)
     else { printf("[MAIN] xTaskCreate(ServerTask) Successful\n"); } // Successful creation of Server Event Generator Task
 
 
-    /* Create Client Dispatcher & Manager Task */
-    if ((xTaskCreate( Task_Dispatcher, "Client_Dispatcher", configMINIMAL_STACK_SIZE,
-                     NULL, NORMAL_PRIORITY, &xClientDispatcherTaskHandle) != pdPASS))
-    { 
-        printf("[MAIN] xTaskCreate(ClientDispatcher_Task) Failed!\n");
-        return -27;
-    }
-    else { printf("[MAIN] xTaskCreate(ClientDispatcher_Task) Successful\n"); } // Successful creation of Client Dispatcher Task
-
-    for (size_t i = 0; i < 6; i++)
-    {   
-        // Create unique task name for each department manager task
-        char taskName[32] = {0};
-        sprintf(taskName, "MANAGER_%s", deptDesc[i].name); // depNames from Shared_Configuration.h
+    return 0;
+}
 
-        if ((xTaskCreate( Task_Manager_Departments_X, taskName, configMINIMAL_STACK_SIZE,
-                     &deptDesc[i], LOW_PRIORITY, &xClientManagerTaskHandle[i]) != pdPASS))
-            { 
-            printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -41;
-            }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Ambulance Task
+/* Create the Client side tasks: UDP TX/RX, dispatcher, department managers and vehicles */
+static int StartClientTasks(void)
+{
+    /* Create UDP tasks */
+    if ((xTaskCreate( vClientUDPTxTask, "Client_UDP_Tx", configMINIMAL_STACK_SIZE,
+                     NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
+    { 
+        printf("[MAIN] xTaskCreate(ClientUDP_Tx_Task) Failed!\n");
+        return -23;
     }
+    else { printf("[MAIN] xTaskCreate(ClientUDP_TxTask) Successful\n"); } // Successful creation of Client UDP TX Task
 
-
-
-    /* Create Client Department Tasks - Based on numbers of vehicles in each department */
-    for (size_t i = 0; i < AMBULANCE_VEHICLES; i++)
-    {   
-        // Create unique task name for each Ambulance vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "AMBULANCE_%zu", i+1);
-
-        if ((xTaskCreate( Task_Ambulance_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientAmbulanceTaskHandle[i]) != pdPASS))
-            { 
-            printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -41;
-            }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Ambulance Task
+    if ((xTaskCreate( vClientUDPRxTask, "Client_UDP_Rx", configMINIMAL_STACK_SIZE,
+                     NULL, MEDIUM_PRIORITY, NULL) != pdPASS))
+    { 
+        printf("[MAIN] xTaskCreate(ClientUDP_Rx_Task) Failed!\n");
+        return -24;
     }
+    else { printf("[MAIN] xTaskCreate(ClientUDP_RxTask) Successful\n"); } // Successful creation of Client UDP RX Task
 
-    for (size_t i = 0; i < POLICE_VEHICLES; i++)
+#if TRANSPORT_BENCH && !FAST_PATH
+    /* Transport benchmark - echo path only (one echo task per RX shard), no dispatcher, managers or vehicles */
+    for (UBaseType_t s = 0; s < DISPATCHER_SHARDS; s++)
     {
-        // Create unique task name for each Police vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "POLICE_%zu", i+1);
+        char taskName[32] = {0};
+        snprintf(taskName, sizeof(taskName), "ECHO_%u", (unsigned)s);
 
-        if ((xTaskCreate( Task_Police_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientPoliceTaskHandle[i]) != pdPASS))
+        if ((xTaskCreate( vClientEchoTask, taskName, configMINIMAL_STACK_SIZE,
+                         (void *)(uintptr_t)s, NORMAL_PRIORITY, NULL) != pdPASS))
         { 
             printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -42;
+            return -28;
         }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Police Task
+        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Echo Task
     }
-
-    for (int i=0; i<FIRE_VEHICLES; i++)
+#endif
+#if TRANSPORT_BENCH
+    return 0; // Fast path benchmark - UDP-RX echoes the events itself
+#endif
+
+#if !FAST_PATH // Fast path - UDP-RX routes into the department queues itself
+    /* Create Client Dispatcher Tasks - one per shard, each owns a disjoint subset of departments */
+    for (UBaseType_t s = 0; s < DISPATCHER_SHARDS; s++)
     {
-        // Create unique task name for each Fire vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "FIRE_%d", i+1);
+        char taskName[32] = {0};
+        snprintf(taskName, sizeof(taskName), "DISPATCHER_%u", (unsigned)s);
 
-        if ((xTaskCreate( Task_Fire_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientFireTaskHandle[i]) != pdPASS))
+        if ((xTaskCreate( Task_Dispatcher, taskName, configMINIMAL_STACK_SIZE,
+                         (void *)(uintptr_t)s, NORMAL_PRIORITY, &xClientDispatcherTaskHandle[s]) != pdPASS))
         { 
             printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -43;
+            return -27;
         }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Fire Task
+        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Dispatcher Task
     }
+#endif
 
-    for (size_t i = 0; i < MAINTENANCE_VEHICLES; i++)
-    {
-        // Create unique task name for each Maintenance vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "MAINTENANCE_%zu", i+1);
-
-        if ((xTaskCreate( Task_Maintenance_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientMaintenanceTaskHandle[i]) != pdPASS))
-        { 
-           printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-           return -44;
-        }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Maintenance Task
-    }
-    
-    for (size_t i = 0; i < WASTE_VEHICLES; i++)
-    {
-        // Create unique task name for each Waste Collection vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "WASTE_%zu", i+1);
-        
-        if ((xTaskCreate( Task_Waste_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientWasteTaskHandle[i]) != pdPASS))
-        { 
-            printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -45;
-        }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Waste Task
+#if MANAGER_SUPERVISOR
+    /* Supervisor mode - one task runs the policies of every department */
+    if ((xTaskCreate( Task_Supervisor, "SUPERVISOR", configMINIMAL_STACK_SIZE,
+                     NULL, LOW_PRIORITY, NULL) != pdPASS))
+    { 
+        printf("[MAIN] xTaskCreate(Client_SUPERVISOR) Failed!\n");
+        return -43;
     }
+    else { printf("[MAIN] xTaskCreate(Client_SUPERVISOR) Successful\n"); } // Successful creation of Client Supervisor Task
+#endif
 
-    for (size_t i = 0; i < ELECTRICITY_VEHICLES; i++)
+    /* Create Manager and Vehicle tasks of every registered department - Based on numbers of vehicles in each department */
+    for (size_t t = 0; t < DEPT_REGISTRY_MAX; t++)
     {
-        // Create unique task name for each Electricity vehicle task
-        char taskName[24] = {0};
-        sprintf(taskName, "ELECTRICITY_%zu", i+1);
+        DepartmentDescription_t *d = Dept_FromType((EventType_t)t);
+        if (d == NULL) continue; // Slot not registered
 
-        if ((xTaskCreate( Task_Electricity_X, taskName, configMINIMAL_STACK_SIZE,
-                     NULL, LOW_PRIORITY, &xClientElectricityTaskHandle[i]) != pdPASS))
+        char taskName[32] = {0};
+
+#if !MANAGER_SUPERVISOR
+        // Create unique task name for each department manager task
+        snprintf(taskName, sizeof(taskName), "MANAGER_%s", d->name);
+
+        if ((xTaskCreate( Task_Manager_Departments_X, taskName, configMINIMAL_STACK_SIZE,
+                     d, LOW_PRIORITY, &xClientManagerTaskHandle[t]) != pdPASS))
         { 
             printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
-            return -46;
+            return -41;
         }
-        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Electricity Task
-    }
-    
+        else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Manager Task
+#endif
 
+#if !SERVICE_CLOCK // Service clock - vehicles are records, not tasks
+        for (UBaseType_t i = 0; i < d->vehicles; i++)
+        {
+            // Create unique task name for each vehicle task
+            snprintf(taskName, sizeof(taskName), "%s_%u", d->name, (unsigned)(i + 1));
 
-    /* Start Scheduler */
-    printf("\n[MAIN] Starting scheduler\n--------------------------------\n");
-    vTaskStartScheduler();
+            if ((xTaskCreate( Task_Vehicle, taskName, configMINIMAL_STACK_SIZE,
+                         &d->fleet[i], VEHICLE_TASK_PRIORITY, NULL) != pdPASS))
+            { 
+                printf("[MAIN] xTaskCreate(Client_%s) Failed!\n", taskName);
+                return -42;
+            }
+            else { printf("[MAIN] xTaskCreate(Client_%s) Successful\n", taskName); } // Successful creation of Client Vehicle Task
+        }
+#endif
+    }
 
+#if SERVICE_CLOCK
+    /* Service clock mode - one task completes the services of every vehicle record */
+    if ((xTaskCreate( Task_ServiceClock, "SERVICE_CLOCK", configMINIMAL_STACK_SIZE,
+                     NULL, LOW_PRIORITY, NULL) != pdPASS))
+    { 
+        printf("[MAIN] xTaskCreate(Client_SERVICE_CLOCK) Failed!\n");
+        return -44;
+    }
+    else { printf("[MAIN] xTaskCreate(Client_SERVICE_CLOCK) Successful\n"); } // Successful creation of Client Service Clock Task
+#endif
 
-    /* Should never reach here! - Print & Endless Loop */
-    printf("\n\n[MAIN] Scheduler returned - Unexpected Error\n");
-    while (1) {} // Endless loop
-    
-    return 100; // Return 100 on unexpected exit
+    return 0;
 }